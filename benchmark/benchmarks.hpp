@@ -0,0 +1,692 @@
+#pragma once
+
+#include "../test/helpers/components.hpp"
+#include "../test/helpers/utils.hpp"
+#include "harness.hpp"
+
+inline constexpr int COUNT_10K = 10000;
+inline constexpr int COUNT_100K = 100000;
+inline constexpr int COUNT_1M = 1000000;
+inline constexpr int COUNT_2M = 2000000;
+
+using Bench::doNotOptimize;
+using Bench::State;
+
+inline void setupBenchmark(CM &cm, int entityCount)
+{
+    createEntityWithComponents<TestVelocityComponent, TestPositionComponent>(cm, entityCount);
+}
+
+inline void bench_2M_create(State &state)
+{
+    CM cm{};
+    state.measure([&] { setupBenchmark(cm, COUNT_2M); });
+}
+
+inline void bench_2M_destroy(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            cm.remove<TestVelocityComponent>(i);
+            cm.remove<TestPositionComponent>(i);
+        }
+    });
+}
+
+inline void bench_2M_get_single_entity_single_type(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    uint32_t count{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [testVelSet, testPosSet] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            testVelSet.inspect([&](auto &_) { count++; });
+            testPosSet.inspect([&](auto &_) { count++; });
+        }
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_get_multiple_entities_single_type(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    uint32_t count{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M + 1; ++i)
+        {
+            auto [vel1, vel2] = cm.get<TestVelocityComponent>(i, i + 1);
+            auto [pos1, pos2] = cm.get<TestPositionComponent>(i + 1, 1);
+            auto &targetVel = i % 2 == 0 ? vel1 : vel2;
+            auto &targetPos = i % 2 == 0 ? pos1 : pos2;
+            targetVel.inspect([&](auto &_) { count++; });
+            targetPos.inspect([&](auto &_) { count++; });
+        }
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_gather(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    uint32_t count{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [velComp, posComp] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            velComp.inspect([&](auto &_) { count++; });
+            posComp.inspect([&](auto &_) { count++; });
+        }
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_get_half_missing(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_1M);
+    uint32_t count{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [velComps, posComps] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            velComps.inspect([&](auto &_) { count++; });
+            posComps.inspect([&](auto &_) { count++; });
+        }
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_try_get_half_missing(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_1M);
+    uint32_t count{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [velComps, posComps] = cm.tryGet<TestVelocityComponent, TestPositionComponent>(i);
+            velComps.inspect([&](auto &_) { count++; });
+            posComps.inspect([&](auto &_) { count++; });
+        }
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_get_all(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    uint32_t count{};
+
+    state.measure([&] {
+        auto [velComps] = cm.getAll<TestVelocityComponent>();
+        auto [posComps] = cm.getAll<TestPositionComponent>();
+        velComps.each([&](EId eId, auto &comps) { comps.inspect([&](auto &_) { count++; }); });
+        posComps.each([&](EId eId, auto &comps) { comps.inspect([&](auto &_) { count++; }); });
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_get_unique(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    cm.add<TestUniqueComp>(COUNT_2M / 2);
+    uint32_t count{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [playerId, playerComps] = cm.getUnique<TestUniqueComp>();
+            playerComps.inspect([&](auto &_) { count++; });
+        }
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_gather_all(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    uint32_t count{};
+
+    state.measure([&] {
+        auto [velComps, posComps] = cm.getAll<TestVelocityComponent, TestPositionComponent>();
+        velComps.each([&](EId eId, auto &comps) { comps.inspect([&](auto &_) { count++; }); });
+        posComps.each([&](EId eId, auto &comps) { comps.inspect([&](auto &_) { count++; }); });
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_gather_group(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    uint32_t count{};
+
+    state.measure([&] {
+        auto group = cm.getGroup<TestVelocityComponent, TestPositionComponent>();
+        group.each([&](EId eId, auto &velComps, auto &posComps) {
+            velComps.inspect([&](auto &_) { count++; });
+            posComps.inspect([&](auto &_) { count++; });
+        });
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_access(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    float sum{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [testVelSet, testPosSet] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            testVelSet.inspect([&](const TestVelocityComponent &testComp) { sum += testComp.x; });
+            testPosSet.inspect([&](const TestPositionComponent &testComp) { sum += testComp.x; });
+        }
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_2M_update(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [testVelSet, testPosSet] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            testVelSet.mutate([&](TestVelocityComponent &testComp) {
+                testComp.x = 10.0f;
+                testComp.y = 10.0f;
+            });
+            testPosSet.mutate([&](TestPositionComponent &testComp) {
+                testComp.x = 10.0f;
+                testComp.y = 10.0f;
+            });
+        }
+    });
+}
+
+inline void bench_2M_clear(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    state.measure([&] {
+        cm.clear<TestVelocityComponent>();
+        cm.clear<TestPositionComponent>();
+    });
+}
+
+inline void bench_10K_event_churn(State &state)
+{
+    CM cm{};
+
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        state.measure([&] {
+            for (int i = 1; i <= COUNT_10K; ++i)
+                cm.add<TestEventComp>(i);
+
+            cm.clear<ECS::Tags::Event>();
+        });
+    }
+}
+
+inline void bench_100K_spatial_query(State &state)
+{
+    CM cm{};
+    for (int i = 1; i <= COUNT_100K; ++i)
+        cm.add<TestGridPositionComp>(i, static_cast<float>(i % 1000), static_cast<float>(i / 100));
+
+    auto &grid = cm.spatialIndex(&TestGridPositionComp::x, &TestGridPositionComp::y, 16.0f);
+    auto [posSet] = cm.getAll<TestGridPositionComp>();
+    std::vector<EntityId> found;
+    size_t foundCount{};
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        posSet.each([&](EId eId, auto &posComps) {
+            posComps.mutate([&](TestGridPositionComp &pos) {
+                pos.x += (eId % 3) - 1.0f;
+                pos.y += (eId % 5) - 2.0f;
+            });
+        });
+
+        state.measure([&] {
+            for (int query = 0; query < 1000; ++query)
+            {
+                grid.queryRadius(static_cast<float>(query), static_cast<float>(query % 1000), 16.0f, found);
+                foundCount += found.size();
+            }
+        });
+    }
+
+    doNotOptimize(foundCount);
+}
+
+// Every entity looks up its neighbors then moves, as collision or steering systems do
+inline void bench_10K_spatial_query_then_move(State &state)
+{
+    CM cm{};
+    for (int i = 1; i <= COUNT_10K; ++i)
+        cm.add<TestGridPositionComp>(i, static_cast<float>(i % 100), static_cast<float>(i / 100));
+
+    auto &grid = cm.spatialIndex(&TestGridPositionComp::x, &TestGridPositionComp::y, 4.0f);
+    auto [posSet] = cm.getAll<TestGridPositionComp>();
+    std::vector<EntityId> found;
+    size_t foundCount{};
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        state.measure([&] {
+            posSet.each([&](EId eId, auto &posComps) {
+                auto [x, y] = posComps.peek(&TestGridPositionComp::x, &TestGridPositionComp::y);
+                grid.queryRadius(x, y, 4.0f, found);
+                foundCount += found.size();
+
+                posComps.mutate([&](TestGridPositionComp &pos) {
+                    pos.x += (eId % 3) - 1.0f;
+                    pos.y += (eId % 5) - 2.0f;
+                });
+            });
+        });
+    }
+
+    doNotOptimize(foundCount);
+}
+
+inline void bench_100K_find_by_value(State &state)
+{
+    CM cm{};
+    for (int i = 1; i <= COUNT_100K; ++i)
+        cm.add<TestNonStackedComp>(i, i % 1000);
+
+    auto &valIndex = cm.index<TestNonStackedComp>(&TestNonStackedComp::val);
+    size_t foundCount{valIndex.count(0)};
+
+    state.measure([&] {
+        for (int i = 0; i < COUNT_100K; ++i)
+            foundCount += valIndex.find(i % 1000).size();
+    });
+
+    doNotOptimize(foundCount);
+}
+
+inline void bench_100K_sort_nearly_sorted(State &state)
+{
+    CM cm{};
+    for (int i = 1; i <= COUNT_100K; ++i)
+        cm.add<TestNonStackedComp>(i, i);
+
+    auto [valSet] = cm.getAll<TestNonStackedComp>();
+    auto byVal = [](EId eId, auto &comps) { return comps.peek(&TestNonStackedComp::val); };
+
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        for (int i = 1; i <= 100; ++i)
+        {
+            auto [comps] = cm.get<TestNonStackedComp>(i * 997 % COUNT_100K + 1);
+            comps.mutate([&](TestNonStackedComp &comp) { comp.val += (frame % 2) ? 3 : -3; });
+        }
+
+        state.measure([&] { valSet.sortBy(byVal); });
+    }
+}
+
+inline void setupStackedBenchmark(CM &cm, int entityCount)
+{
+    for (int i = 1; i <= entityCount; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+            cm.add<TestStackedComp>(i, i + j);
+    }
+}
+
+inline void bench_100K_filter_sort_first(State &state)
+{
+    CM cm{};
+    setupStackedBenchmark(cm, COUNT_100K);
+#ifdef ecs_enable_memory_resource
+    cm.reserveScratch();
+#endif
+
+    int sum{};
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_100K; ++i)
+        {
+            auto [comps] = cm.get<TestStackedComp>(i);
+            comps.filter([](const TestStackedComp &comp) { return comp.val % 2 == 0; })
+                .sort([](const TestStackedComp &a, const TestStackedComp &b) { return a.val > b.val; })
+                .first()
+                .inspect([&](const TestStackedComp &comp) { sum += comp.val; });
+        }
+#ifdef ecs_enable_memory_resource
+        cm.resetScratch();
+#endif
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_100K_view_filter_take(State &state)
+{
+    CM cm{};
+    setupStackedBenchmark(cm, COUNT_100K);
+
+    auto isEven = [](const TestStackedComp &comp) { return comp.val % 2 == 0; };
+    int sum{};
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_100K; ++i)
+        {
+            auto [comps] = cm.get<TestStackedComp>(i);
+            for (const auto &comp : comps.view() | std::views::filter(isEven) | std::views::take(1))
+                sum += comp.val;
+        }
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_100K_sort_first(State &state)
+{
+    CM cm{};
+    setupStackedBenchmark(cm, COUNT_100K);
+    auto byValDesc = [](const TestStackedComp &a, const TestStackedComp &b) { return a.val > b.val; };
+    int sum{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_100K; ++i)
+        {
+            auto [comps] = cm.get<TestStackedComp>(i);
+            comps.sort(byValDesc).first().inspect([&](const TestStackedComp &comp) { sum += comp.val; });
+        }
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_100K_max_by(State &state)
+{
+    CM cm{};
+    setupStackedBenchmark(cm, COUNT_100K);
+    int sum{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_100K; ++i)
+        {
+            auto [comps] = cm.get<TestStackedComp>(i);
+            comps.maxBy(&TestStackedComp::val).inspect([&](const TestStackedComp &comp) { sum += comp.val; });
+        }
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_100K_group_top_10(State &state)
+{
+    CM cm{};
+    for (int i = 1; i <= COUNT_100K; ++i)
+        cm.add<TestNonStackedComp>(i, i * 7919 % COUNT_100K);
+    auto byVal = [](EId eId, auto &comps) { return comps.peek(&TestNonStackedComp::val); };
+    size_t count{};
+
+    state.measure([&] {
+        auto group = cm.getGroup<TestNonStackedComp>();
+        count += group.topBy(10, byVal, std::greater<>{}).size();
+    });
+
+    doNotOptimize(count);
+}
+
+inline void bench_2M_sum_field_each(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    float sum{};
+
+    state.measure([&] {
+        auto [posSet] = cm.getAll<TestPositionComponent>();
+        posSet.each([&](EId eId, auto &comps) {
+            comps.inspect([&](const TestPositionComponent &comp) { sum += comp.x; });
+        });
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_2M_sum_field_summarize(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    float sum{};
+
+    state.measure([&] {
+        auto [posSet] = cm.getAll<TestPositionComponent>();
+        sum += posSet.summarize(&TestPositionComponent::x).sum;
+    });
+
+    doNotOptimize(sum);
+}
+
+#ifdef ecs_allow_unsafe
+inline void bench_2M_unpack(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    float sum{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [posComps] = cm.get<TestPositionComponent>(i);
+            for (auto *comp : posComps.unpack())
+                sum += comp->x;
+        }
+    });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_2M_unpack_span(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+    float sum{};
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [posComps] = cm.get<TestPositionComponent>(i);
+            for (auto &comp : posComps.unpackSpan())
+                sum += comp.x;
+        }
+    });
+
+    doNotOptimize(sum);
+}
+#endif
+
+template <typename T> inline void inspectAndMutateAll(CM &cm, int &sum)
+{
+    auto [compSet] = cm.getAll<T>();
+    compSet.each([&](EId eId, auto &comps) {
+        comps.inspect([&](const T &comp) { sum += comp.val; });
+        comps.mutate([&](T &comp) { comp.val += 1; });
+    });
+}
+
+inline void bench_100K_inspect_mutate_stacked(State &state)
+{
+    CM cm{};
+    setupStackedBenchmark(cm, COUNT_100K);
+    int sum{};
+
+    state.measure([&] { inspectAndMutateAll<TestStackedComp>(cm, sum); });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_100K_inspect_mutate_non_stacked(State &state)
+{
+    CM cm{};
+    for (int i = 1; i <= COUNT_100K; ++i)
+        cm.add<TestNonStackedComp>(i, i);
+    int sum{};
+
+    state.measure([&] { inspectAndMutateAll<TestNonStackedComp>(cm, sum); });
+
+    doNotOptimize(sum);
+}
+
+inline void bench_2M_memory_stats(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    state.measure([&] { doNotOptimize(cm.memoryStats().totalBytes()); });
+}
+
+inline void bench_2M_memory_stats_sets_only(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    ECS::MemoryStats stats;
+    state.measure([&] {
+        cm.memoryStats(stats, false);
+        doNotOptimize(stats.totalBytes());
+    });
+}
+
+inline void bench_2M_remove(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [testVelSet, testPosSet] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            testVelSet.remove([&](const TestVelocityComponent &testComp) { return true; });
+            testPosSet.remove([&](const TestPositionComponent &testComp) { return true; });
+        }
+    });
+}
+
+inline void bench_2M_remove_and_auto_prune(State &state)
+{
+    CM cm{};
+    setupBenchmark(cm, COUNT_2M);
+
+    state.measure([&] {
+        for (int i = 1; i <= COUNT_2M; ++i)
+        {
+            auto [testVelSet, testPosSet] = cm.get<TestVelocityComponent, TestPositionComponent>(i);
+            testVelSet.remove([&](const TestVelocityComponent &testComp) { return true; });
+            testPosSet.remove([&](const TestPositionComponent &testComp) { return true; });
+        }
+
+        auto [velComps] = cm.getAll<TestVelocityComponent>();
+        auto [posComps] = cm.getAll<TestPositionComponent>();
+        velComps.each([&](EId eId, auto &_) {});
+        posComps.each([&](EId eId, auto &_) {});
+    });
+}
+
+inline void bench_2M_teardown(State &state)
+{
+    std::optional<CM> cm{std::in_place};
+    setupBenchmark(*cm, COUNT_2M);
+
+    state.measure([&] { cm.reset(); });
+}
+
+#ifdef ecs_enable_memory_resource
+inline void bench_2M_teardown_monotonic_resource(State &state)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    std::optional<CM> cm{std::in_place, &resource};
+    setupBenchmark(*cm, COUNT_2M);
+
+    state.measure([&] {
+        cm.reset();
+        resource.release();
+    });
+}
+#endif
+
+// clang-format off
+inline std::vector<Bench::Benchmark> benchmarks{
+    {"2M_create", COUNT_2M, bench_2M_create},
+    {"2M_get_single_entity_single_type", COUNT_2M, bench_2M_get_single_entity_single_type},
+    {"2M_get_multiple_entities_single_type", COUNT_2M, bench_2M_get_multiple_entities_single_type},
+    {"2M_get_all", COUNT_2M, bench_2M_get_all},
+    {"2M_get_unique", COUNT_2M, bench_2M_get_unique},
+    {"2M_gather", COUNT_2M, bench_2M_gather},
+    {"2M_get_half_missing", COUNT_2M, bench_2M_get_half_missing},
+    {"2M_try_get_half_missing", COUNT_2M, bench_2M_try_get_half_missing},
+    {"2M_gather_all", COUNT_2M, bench_2M_gather_all},
+    {"2M_gather_group", COUNT_2M, bench_2M_gather_group},
+    {"2M_access", COUNT_2M, bench_2M_access},
+    {"2M_update", COUNT_2M, bench_2M_update},
+    {"2M_destroy", COUNT_2M, bench_2M_destroy},
+    {"2M_clear", COUNT_2M, bench_2M_clear},
+    {"10K_event_churn", COUNT_10K, bench_10K_event_churn},
+    {"100K_spatial_query", 1000, bench_100K_spatial_query},
+    {"10K_spatial_query_then_move", COUNT_10K, bench_10K_spatial_query_then_move},
+    {"100K_find_by_value", COUNT_100K, bench_100K_find_by_value},
+    {"100K_sort_nearly_sorted", COUNT_100K, bench_100K_sort_nearly_sorted},
+    {"100K_filter_sort_first", COUNT_100K, bench_100K_filter_sort_first},
+    {"100K_view_filter_take", COUNT_100K, bench_100K_view_filter_take},
+    {"100K_sort_first", COUNT_100K, bench_100K_sort_first},
+    {"100K_max_by", COUNT_100K, bench_100K_max_by},
+    {"100K_group_top_10", COUNT_100K, bench_100K_group_top_10},
+    {"2M_sum_field_each", COUNT_2M, bench_2M_sum_field_each},
+    {"2M_sum_field_summarize", COUNT_2M, bench_2M_sum_field_summarize},
+#ifdef ecs_allow_unsafe
+    {"2M_unpack", COUNT_2M, bench_2M_unpack},
+    {"2M_unpack_span", COUNT_2M, bench_2M_unpack_span},
+#endif
+    {"100K_inspect_mutate_stacked", COUNT_100K, bench_100K_inspect_mutate_stacked},
+    {"100K_inspect_mutate_non_stacked", COUNT_100K, bench_100K_inspect_mutate_non_stacked},
+    {"2M_memory_stats", COUNT_2M, bench_2M_memory_stats},
+    {"2M_memory_stats_sets_only", 1, bench_2M_memory_stats_sets_only},
+    {"2M_teardown", COUNT_2M, bench_2M_teardown},
+#ifdef ecs_enable_memory_resource
+    {"2M_teardown_monotonic_resource", COUNT_2M, bench_2M_teardown_monotonic_resource},
+#endif
+    {"2M_remove", COUNT_2M, bench_2M_remove},
+#ifndef ecs_disable_auto_prune
+    {"2M_remove_and_auto_prune", COUNT_2M, bench_2M_remove_and_auto_prune},
+#endif
+};
+// clang-format on
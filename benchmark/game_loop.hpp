@@ -0,0 +1,237 @@
+#pragma once
+
+#include "../test/core.hpp"
+#include "harness.hpp"
+
+/*
+ * Macrobenchmark of a full frame loop, modeled on a shoot 'em up such as Block Invaders.  Every frame spawns
+ * and despawns projectiles, applies stacked damage events, clears the events, looks up the unique player,
+ * reads transformed movement, and runs grouped updates.  One sample is recorded per frame, so the
+ * percentiles are frame times.
+ */
+namespace GameLoop
+{
+
+using Bench::doNotOptimize;
+using Bench::State;
+
+struct Player : ECS::Tags::Unique
+{
+};
+
+struct Position : ECS::Tags::NoStack
+{
+    float x{};
+    float y{};
+
+    Position()
+    {
+    }
+    Position(float _x, float _y) : x(_x), y(_y)
+    {
+    }
+};
+
+// Read through the registered transformation, eg: to apply a slow-down
+struct Movement : ECS::Tags::NoStack, ECS::Tags::Transform
+{
+    float x{};
+    float y{};
+
+    Movement()
+    {
+    }
+    Movement(float _x, float _y) : x(_x), y(_y)
+    {
+    }
+};
+
+struct Projectile : ECS::Tags::NoStack
+{
+    EntityId ownerId{};
+    int framesLeft{};
+
+    Projectile()
+    {
+    }
+    Projectile(EntityId owner, int frames) : ownerId(owner), framesLeft(frames)
+    {
+    }
+};
+
+struct Health : ECS::Tags::NoStack
+{
+    int hp{100};
+};
+
+// Stacks when an enemy is hit several times in a frame
+struct Damage : ECS::Tags::Event, ECS::Tags::Stack
+{
+    int amount{};
+
+    Damage()
+    {
+    }
+    Damage(int _amount) : amount(_amount)
+    {
+    }
+};
+
+struct Config
+{
+    int frames{600};
+    int enemies{10000};
+    // Churn: projectiles spawned per frame, each one despawned after its lifetime
+    int projectilesPerFrame{200};
+    int projectileLifetime{60};
+    // Churn: one enemy in every n is hit each frame, with several stacked damage events
+    int hitEveryNthEnemy{10};
+    int hitsPerEnemy{3};
+};
+
+inline void spawnEnemies(CM &cm, const Config &config)
+{
+    for (int i = 0; i < config.enemies; ++i)
+    {
+        auto eId = cm.createEntity();
+        cm.add<Position>(eId, static_cast<float>(i % 100), static_cast<float>(i / 100));
+        cm.add<Movement>(eId, 1.0f, 0.0f);
+        cm.add<Health>(eId);
+    }
+}
+
+inline void spawnProjectiles(CM &cm, const Config &config, EntityId playerId)
+{
+    for (int i = 0; i < config.projectilesPerFrame; ++i)
+    {
+        auto eId = cm.createEntity();
+        cm.add<Position>(eId, static_cast<float>(i), 0.0f);
+        cm.add<Movement>(eId, 0.0f, 4.0f);
+        cm.add<Projectile>(eId, playerId, config.projectileLifetime);
+    }
+}
+
+inline void despawnProjectiles(CM &cm, std::vector<EntityId> &expired)
+{
+    expired.clear();
+    auto [projectiles] = cm.getAll<Projectile>();
+    projectiles.each([&](EntityId eId, auto &projectileComps) {
+        projectileComps.mutate([&](Projectile &projectile) {
+            if (--projectile.framesLeft <= 0)
+                expired.push_back(eId);
+        });
+    });
+
+    cm.remove(expired);
+}
+
+inline void hitEnemies(CM &cm, const Config &config, int frame, EntityId firstEnemyId)
+{
+    for (int i = frame % config.hitEveryNthEnemy; i < config.enemies; i += config.hitEveryNthEnemy)
+    {
+        for (int hit = 0; hit < config.hitsPerEnemy; ++hit)
+            cm.add<Damage>(firstEnemyId + i, 5 + hit);
+    }
+}
+
+inline void applyDamage(CM &cm)
+{
+    auto group = cm.getGroup<Damage, Health>();
+    group.each([&](EntityId eId, auto &damageComps, auto &healthComps) {
+        int total{};
+        damageComps.inspect([&](const Damage &damage) { total += damage.amount; });
+        healthComps.mutate([&](Health &health) {
+            health.hp -= total;
+            // Respawn in place to keep the population steady
+            if (health.hp <= 0)
+                health.hp = 100;
+        });
+    });
+}
+
+inline void move(CM &cm)
+{
+    auto group = cm.getGroup<Movement, Position>();
+    group.each([&](EntityId eId, auto &movementComps, auto &positionComps) {
+        auto [x, y] = movementComps.peek(&Movement::x, &Movement::y);
+        positionComps.mutate([&](Position &position) {
+            position.x += x;
+            position.y += y;
+        });
+    });
+}
+
+inline void movePlayer(CM &cm, int frame)
+{
+    auto [playerId, playerComps] = cm.getUnique<Player>();
+    auto [positionComps] = cm.get<Position>(playerId);
+    positionComps.mutate([&](Position &position) { position.x = static_cast<float>(frame % 100); });
+}
+
+/**
+ * @brief Build the game loop benchmark
+ *
+ * @param Configuration, mainly the churn rates
+ *
+ * @return Benchmark function, recording one sample per frame
+ */
+[[nodiscard]] inline std::function<void(State &)> makeGameLoop(Config config)
+{
+    return [config](State &state) {
+        CM cm{};
+        cm.registerTransformation<Movement>([](EntityId eId, Movement movement) {
+            // Every fourth entity is slowed down
+            if (eId % 4 == 0)
+            {
+                movement.x *= 0.5f;
+                movement.y *= 0.5f;
+            }
+            return movement;
+        });
+
+        auto playerId = cm.createEntity();
+        cm.add<Player>(playerId);
+        cm.add<Position>(playerId);
+
+        auto firstEnemyId = playerId + 1;
+        spawnEnemies(cm, config);
+
+        std::vector<EntityId> expired;
+        for (int frame = 0; frame < config.frames; ++frame)
+        {
+            state.measure([&] {
+                movePlayer(cm, frame);
+                spawnProjectiles(cm, config, playerId);
+                hitEnemies(cm, config, frame, firstEnemyId);
+                move(cm);
+                applyDamage(cm);
+                despawnProjectiles(cm, expired);
+                cm.clear<ECS::Tags::Event>();
+            });
+        }
+
+        doNotOptimize(expired.size());
+    };
+}
+
+[[nodiscard]] inline std::vector<Bench::Benchmark> getBenchmarks()
+{
+    Config low{};
+    low.projectilesPerFrame = 20;
+    low.hitEveryNthEnemy = 100;
+
+    Config high{};
+    high.projectilesPerFrame = 1000;
+    high.projectileLifetime = 30;
+    high.hitEveryNthEnemy = 2;
+    high.hitsPerEnemy = 5;
+
+    // One item per frame, so the cost per item is the frame time
+    return {
+        {"game_loop_low_churn", 1, makeGameLoop(low)},
+        {"game_loop_default_churn", 1, makeGameLoop(Config{})},
+        {"game_loop_high_churn", 1, makeGameLoop(high)},
+    };
+}
+
+} // namespace GameLoop
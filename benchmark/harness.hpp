@@ -0,0 +1,496 @@
+#pragma once
+
+#include "../test/helpers/allocations.hpp"
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Bench
+{
+
+/**
+ * @brief Collects the timing samples of a benchmark
+ *
+ * A benchmark function does its setup, then wraps the code under measurement in .measure().  Every call to
+ * .measure() records one sample, so a benchmark may record several samples per run, eg: one per frame.  The
+ * heap allocations made during the samples are counted as well, along with the hardware counters when given.
+ */
+class State
+{
+  public:
+    explicit State(PerfCounters *perfCounters = nullptr) : m_perfCounters(perfCounters)
+    {
+    }
+
+    template <typename Func> void measure(Func &&fn)
+    {
+        Allocations::Scope allocations;
+        if (m_perfCounters)
+            m_perfCounters->start();
+
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+
+        if (m_perfCounters)
+            m_perfValues += m_perfCounters->stop();
+
+        m_allocations += allocations.getAllocations();
+        m_allocatedBytes += allocations.getBytes();
+        m_samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+
+    [[nodiscard]] const std::vector<double> &getSamples() const
+    {
+        return m_samples;
+    }
+
+    [[nodiscard]] uint64_t getAllocations() const
+    {
+        return m_allocations;
+    }
+
+    [[nodiscard]] uint64_t getAllocatedBytes() const
+    {
+        return m_allocatedBytes;
+    }
+
+    [[nodiscard]] const PerfValues &getPerfValues() const
+    {
+        return m_perfValues;
+    }
+
+  private:
+    PerfCounters *m_perfCounters;
+    PerfValues m_perfValues{};
+    std::vector<double> m_samples{};
+    uint64_t m_allocations{};
+    uint64_t m_allocatedBytes{};
+};
+
+/**
+ * @brief Keeps the compiler from optimizing away a value which is otherwise unused
+ */
+template <typename T> inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark
+{
+    std::string name;
+    // Items processed by a single measured sample, eg: entities, used for the per-item cost
+    size_t items;
+    std::function<void(State &)> fn;
+};
+
+struct Result
+{
+    std::string name;
+    size_t items{};
+    size_t samples{};
+    double medianNs{};
+    double p95Ns{};
+    double p99Ns{};
+    double meanNs{};
+    double stddevNs{};
+    double minNs{};
+    // Heap allocations and allocated bytes, averaged over the samples
+    double allocations{};
+    double allocatedBytes{};
+    // Hardware counters, averaged over the samples
+    PerfValues perf{};
+
+    [[nodiscard]] double nsPerItem() const
+    {
+        return perItem(medianNs);
+    }
+
+    [[nodiscard]] double allocationsPerItem() const
+    {
+        return perItem(allocations);
+    }
+
+    [[nodiscard]] double bytesPerItem() const
+    {
+        return perItem(allocatedBytes);
+    }
+
+    [[nodiscard]] double perfPerItem(PerfEvent event) const
+    {
+        return perItem(perf[event]);
+    }
+
+    [[nodiscard]] bool hasPerf() const
+    {
+        return perf.isCounted[0];
+    }
+
+  private:
+    [[nodiscard]] double perItem(double value) const
+    {
+        return items ? value / items : value;
+    }
+};
+
+struct Options
+{
+    std::string filter{};
+    int warmup{1};
+    int repetitions{5};
+    std::string jsonPath{};
+    std::string baselinePath{};
+    // Relative slowdown of the median, compared to the baseline, which counts as a regression
+    double threshold{0.10};
+    // Also run the scaling sweeps, up to the maximum entity count
+    bool shouldSweep{false};
+    size_t maxEntities{10000000};
+    // Also print the heap allocations and allocated bytes per item
+    bool shouldShowAllocations{false};
+    // Also read the hardware performance counters, on Linux
+    bool shouldReadPerf{false};
+};
+
+[[nodiscard]] inline double percentile(std::vector<double> sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+
+    std::sort(sorted.begin(), sorted.end());
+    auto rank = fraction * (sorted.size() - 1);
+    auto lower = static_cast<size_t>(std::floor(rank));
+    auto upper = static_cast<size_t>(std::ceil(rank));
+
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+}
+
+[[nodiscard]] inline Result summarize(const Benchmark &benchmark, const State &state)
+{
+    const auto &samples = state.getSamples();
+    Result result{benchmark.name, benchmark.items, samples.size()};
+    if (samples.empty())
+        return result;
+
+    result.allocations = static_cast<double>(state.getAllocations()) / samples.size();
+    result.allocatedBytes = static_cast<double>(state.getAllocatedBytes()) / samples.size();
+    result.perf = state.getPerfValues();
+    for (auto &value : result.perf.values)
+        value /= samples.size();
+
+    result.medianNs = percentile(samples, 0.5);
+    result.p95Ns = percentile(samples, 0.95);
+    result.p99Ns = percentile(samples, 0.99);
+    result.minNs = *std::min_element(samples.begin(), samples.end());
+
+    double sum{};
+    for (auto sample : samples)
+        sum += sample;
+    result.meanNs = sum / samples.size();
+
+    double squaredDiffs{};
+    for (auto sample : samples)
+        squaredDiffs += (sample - result.meanNs) * (sample - result.meanNs);
+    result.stddevNs = std::sqrt(squaredDiffs / samples.size());
+
+    return result;
+}
+
+/**
+ * @brief Run a benchmark, discarding the samples of the warmup runs
+ */
+[[nodiscard]] inline Result runBenchmark(const Benchmark &benchmark, const Options &options,
+                                         PerfCounters *perfCounters = nullptr)
+{
+    for (int i = 0; i < options.warmup; ++i)
+    {
+        State warmupState;
+        benchmark.fn(warmupState);
+    }
+
+    State state(perfCounters);
+    for (int i = 0; i < options.repetitions; ++i)
+        benchmark.fn(state);
+
+    return summarize(benchmark, state);
+}
+
+inline void printHeader(const Options &options)
+{
+    std::cout << std::left << std::setw(44) << "BENCHMARK" << std::right << std::setw(8) << "SAMPLES"
+              << std::setw(14) << "MEDIAN ms" << std::setw(14) << "P95 ms" << std::setw(14) << "P99 ms"
+              << std::setw(14) << "STDDEV ms" << std::setw(14) << "ns/item";
+    if (options.shouldShowAllocations)
+        std::cout << std::setw(14) << "allocs/item" << std::setw(14) << "bytes/item";
+    std::cout << "\n";
+}
+
+inline void printResult(const Result &result, const Options &options)
+{
+    std::cout << std::left << std::setw(44) << result.name << std::right << std::setw(8) << result.samples
+              << std::fixed << std::setprecision(3) << std::setw(14) << result.medianNs / 1e6 << std::setw(14)
+              << result.p95Ns / 1e6 << std::setw(14) << result.p99Ns / 1e6 << std::setw(14)
+              << result.stddevNs / 1e6 << std::setw(14) << result.nsPerItem();
+    if (options.shouldShowAllocations)
+        std::cout << std::setw(14) << result.allocationsPerItem() << std::setw(14) << result.bytesPerItem();
+    std::cout << "\n";
+}
+
+/**
+ * @brief Print the hardware counters per item of every result which has them
+ */
+inline void printPerf(const std::vector<Result> &results)
+{
+    std::cout << "\n" << std::left << std::setw(44) << "HARDWARE COUNTERS PER ITEM" << std::right;
+    for (auto name : PERF_EVENT_NAMES)
+        std::cout << std::setw(13) << name;
+    std::cout << std::setw(13) << "IPC" << "\n";
+
+    for (const auto &result : results)
+    {
+        if (!result.hasPerf())
+            continue;
+
+        std::cout << std::left << std::setw(44) << result.name << std::right << std::fixed
+                  << std::setprecision(3);
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        {
+            if (result.perf.isCounted[i])
+                std::cout << std::setw(13) << result.perfPerItem(static_cast<PerfEvent>(i));
+            else
+                std::cout << std::setw(13) << "-";
+        }
+
+        auto cycles = result.perf[PerfEvent::CYCLES];
+        std::cout << std::setw(13) << (cycles ? result.perf[PerfEvent::INSTRUCTIONS] / cycles : 0) << "\n";
+    }
+}
+
+/**
+ * @brief Write the results as JSON, one benchmark per line so the files diff cleanly
+ */
+inline void writeJson(const std::vector<Result> &results, const std::string &path)
+{
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(3) << "{\"benchmarks\":[\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto &result = results[i];
+        out << "{\"name\":\"" << result.name << "\",\"items\":" << result.items
+            << ",\"samples\":" << result.samples << ",\"median_ns\":" << result.medianNs
+            << ",\"p95_ns\":" << result.p95Ns << ",\"p99_ns\":" << result.p99Ns
+            << ",\"mean_ns\":" << result.meanNs
+            << ",\"stddev_ns\":" << result.stddevNs << ",\"min_ns\":" << result.minNs
+            << ",\"ns_per_item\":" << result.nsPerItem()
+            << ",\"allocs_per_item\":" << result.allocationsPerItem()
+            << ",\"bytes_per_item\":" << result.bytesPerItem();
+        for (size_t event = 0; event < PERF_EVENT_COUNT; ++event)
+        {
+            if (result.perf.isCounted[event])
+                out << ",\"" << PERF_EVENT_NAMES[event]
+                    << "_per_item\":" << result.perfPerItem(static_cast<PerfEvent>(event));
+        }
+        out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+}
+
+/**
+ * @brief Read the median of every benchmark from JSON written by writeJson()
+ */
+[[nodiscard]] inline std::map<std::string, double> readBaseline(const std::string &path)
+{
+    std::map<std::string, double> medians;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        auto nameStart = line.find("\"name\":\"");
+        auto medianStart = line.find("\"median_ns\":");
+        if (nameStart == std::string::npos || medianStart == std::string::npos)
+            continue;
+
+        nameStart += 8;
+        auto name = line.substr(nameStart, line.find('"', nameStart) - nameStart);
+        medians[name] = std::stod(line.substr(medianStart + 12));
+    }
+
+    return medians;
+}
+
+/**
+ * @brief Compare the medians against the baseline
+ *
+ * @return Number of regressions
+ */
+inline int compareToBaseline(const std::vector<Result> &results, const Options &options)
+{
+    auto baseline = readBaseline(options.baselinePath);
+    if (baseline.empty())
+    {
+        std::cout << "\nNo baseline results could be read from " << options.baselinePath << "\n";
+        return 0;
+    }
+
+    int regressions{};
+    std::cout << "\n" << std::left << std::setw(44) << "BASELINE COMPARISON" << std::right << std::setw(14)
+              << "CHANGE" << "\n";
+    for (const auto &result : results)
+    {
+        auto iter = baseline.find(result.name);
+        if (iter == baseline.end() || iter->second <= 0)
+            continue;
+
+        auto change = result.medianNs / iter->second - 1;
+        bool isRegression = change > options.threshold;
+        regressions += isRegression;
+
+        std::cout << std::left << std::setw(44) << result.name << std::right << std::showpos << std::setw(13)
+                  << std::setprecision(1) << change * 100 << "%" << std::noshowpos
+                  << (isRegression ? "  REGRESSION" : "") << "\n";
+    }
+
+    return regressions;
+}
+
+/**
+ * @brief Print the command line options
+ */
+inline void printUsage(std::ostream &out, const char *program)
+{
+    out << "Usage: " << program << " [options]\n"
+        << "  --filter <text>         Only run the benchmarks whose name contains the text\n"
+        << "  --warmup <count>        Unmeasured runs before the samples, default 1\n"
+        << "  --reps <count>          Measured runs of every benchmark, default 5\n"
+        << "  --json <path>           Write the results as JSON\n"
+        << "  --baseline <path>       Compare the medians against results written by --json\n"
+        << "  --threshold <fraction>  Slowdown which counts as a regression, default 0.10\n"
+        << "  --sweep                 Also run the scaling sweeps\n"
+        << "  --max-entities <count>  Largest entity count of the sweeps, default 10000000\n"
+        << "  --allocs                Also print the heap allocations per item\n"
+        << "  --perf                  Also read the hardware performance counters, on Linux\n"
+        << "  --help                  Print this message\n";
+}
+
+/**
+ * @brief Parse the command line, or print the usage and exit when asked to or given an unknown argument
+ */
+[[nodiscard]] inline Options parseOptions(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue)
+            options.filter = argv[++i];
+        else if (arg == "--warmup" && hasValue)
+            options.warmup = std::stoi(argv[++i]);
+        else if (arg == "--reps" && hasValue)
+            options.repetitions = std::stoi(argv[++i]);
+        else if (arg == "--json" && hasValue)
+            options.jsonPath = argv[++i];
+        else if (arg == "--baseline" && hasValue)
+            options.baselinePath = argv[++i];
+        else if (arg == "--threshold" && hasValue)
+            options.threshold = std::stod(argv[++i]);
+        else if (arg == "--sweep")
+            options.shouldSweep = true;
+        else if (arg == "--max-entities" && hasValue)
+            options.maxEntities = std::stoull(argv[++i]);
+        else if (arg == "--allocs")
+            options.shouldShowAllocations = true;
+        else if (arg == "--perf")
+            options.shouldReadPerf = true;
+        else if (arg == "--help" || arg == "-h")
+        {
+            printUsage(std::cout, argv[0]);
+            std::exit(EXIT_SUCCESS);
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+            printUsage(std::cerr, argv[0]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    return options;
+}
+
+/**
+ * @brief Run every benchmark whose name contains the filter, printing each result as it completes
+ *
+ * @return Results
+ */
+[[nodiscard]] inline std::vector<Result> runAll(const std::vector<Benchmark> &benchmarks,
+                                                const Options &options)
+{
+    std::vector<Result> results;
+
+    std::unique_ptr<PerfCounters> perfCounters;
+    if (options.shouldReadPerf)
+    {
+        perfCounters = std::make_unique<PerfCounters>();
+        if (!perfCounters->isAvailable())
+        {
+            std::cout << "Hardware counters are unavailable, " << perfCounters->getUnavailableReason()
+                      << "\n\n";
+            perfCounters.reset();
+        }
+    }
+
+    printHeader(options);
+    for (const auto &benchmark : benchmarks)
+    {
+        if (benchmark.name.find(options.filter) == std::string::npos)
+            continue;
+
+        results.push_back(runBenchmark(benchmark, options, perfCounters.get()));
+        printResult(results.back(), options);
+    }
+
+    if (perfCounters)
+        printPerf(results);
+
+    return results;
+}
+
+/**
+ * @brief Write the results as JSON and compare them to the baseline, when requested
+ *
+ * @return Process exit code, non-zero when a benchmark regressed compared to the baseline
+ */
+inline int report(const std::vector<Result> &results, const Options &options)
+{
+    if (!options.jsonPath.empty())
+        writeJson(results, options.jsonPath);
+
+    if (options.baselinePath.empty())
+        return 0;
+
+    return compareToBaseline(results, options) ? 1 : 0;
+}
+
+/**
+ * @brief Run every benchmark whose name contains the filter, and report the results
+ *
+ * @return Process exit code, non-zero when a benchmark regressed compared to the baseline
+ */
+inline int run(const std::vector<Benchmark> &benchmarks, const Options &options)
+{
+    return report(runAll(benchmarks, options), options);
+}
+
+} // namespace Bench
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Bench
+{
+
+enum class PerfEvent
+{
+    CYCLES = 0,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    COUNT,
+};
+
+inline constexpr size_t PERF_EVENT_COUNT = static_cast<size_t>(PerfEvent::COUNT);
+inline constexpr std::array<const char *, PERF_EVENT_COUNT> PERF_EVENT_NAMES{
+    "cycles", "instructions", "L1d-miss", "LLC-miss", "branch-miss"};
+
+struct PerfValues
+{
+    std::array<double, PERF_EVENT_COUNT> values{};
+    // Events which could not be opened, eg: unsupported by the CPU or the hypervisor, are not counted
+    std::array<bool, PERF_EVENT_COUNT> isCounted{};
+
+    [[nodiscard]] double &operator[](PerfEvent event)
+    {
+        return values[static_cast<size_t>(event)];
+    }
+
+    [[nodiscard]] double operator[](PerfEvent event) const
+    {
+        return values[static_cast<size_t>(event)];
+    }
+
+    PerfValues &operator+=(const PerfValues &other)
+    {
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        {
+            values[i] += other.values[i];
+            isCounted[i] = isCounted[i] || other.isCounted[i];
+        }
+
+        return *this;
+    }
+};
+
+/**
+ * @brief Reads the hardware performance counters of the calling thread through perf_event_open
+ *
+ * The events are opened as a single group so they are scheduled together, and the values are scaled when
+ * the kernel multiplexes the group.  When the counters are not permitted, eg: perf_event_paranoid is too
+ * strict or the platform is not Linux, .isAvailable() is false, the reason is kept, and start/stop do
+ * nothing.
+ */
+class PerfCounters
+{
+  public:
+    PerfCounters()
+    {
+#ifdef __linux__
+        m_fds.fill(-1);
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        {
+            auto [type, config] = getEventConfig(static_cast<PerfEvent>(i));
+            m_fds[i] = open(type, config, m_fds[0]);
+            if (i == 0 && m_fds[0] < 0)
+            {
+                auto error = errno;
+                m_unavailableReason = std::string("perf_event_open failed: ") + std::strerror(error) +
+                                      (error == EACCES || error == EPERM
+                                           ? ", check /proc/sys/kernel/perf_event_paranoid"
+                                           : ", the hardware counters may not be exposed, eg: in a VM");
+                return;
+            }
+
+            if (m_fds[i] >= 0)
+                m_groupIndices[i] = m_groupSize++;
+        }
+#else
+        m_unavailableReason = "hardware counters are only supported on Linux";
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for (auto fd : m_fds)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    [[nodiscard]] bool isAvailable() const
+    {
+        return m_unavailableReason.empty();
+    }
+
+    [[nodiscard]] const std::string &getUnavailableReason() const
+    {
+        return m_unavailableReason;
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        if (!isAvailable())
+            return;
+
+        ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    [[nodiscard]] PerfValues stop()
+    {
+        PerfValues result;
+#ifdef __linux__
+        if (!isAvailable())
+            return result;
+
+        ioctl(m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // Layout of PERF_FORMAT_GROUP with the enabled and running times
+        struct
+        {
+            uint64_t count;
+            uint64_t timeEnabled;
+            uint64_t timeRunning;
+            uint64_t values[PERF_EVENT_COUNT];
+        } data{};
+        if (read(m_fds[0], &data, sizeof(data)) <= 0 || !data.timeRunning)
+            return result;
+
+        auto scale = static_cast<double>(data.timeEnabled) / data.timeRunning;
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        {
+            if (m_fds[i] < 0)
+                continue;
+
+            result.values[i] = data.values[m_groupIndices[i]] * scale;
+            result.isCounted[i] = true;
+        }
+#endif
+        return result;
+    }
+
+  private:
+#ifdef __linux__
+    [[nodiscard]] static std::pair<uint32_t, uint64_t> getEventConfig(PerfEvent event)
+    {
+        switch (event)
+        {
+        case PerfEvent::CYCLES:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+        case PerfEvent::INSTRUCTIONS:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+        case PerfEvent::L1D_MISSES:
+            return {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+        case PerfEvent::LLC_MISSES:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+        default:
+            return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+        }
+    }
+
+    [[nodiscard]] static int open(uint32_t type, uint64_t config, int groupFd)
+    {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = groupFd < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+            PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+
+    std::array<int, PERF_EVENT_COUNT> m_fds{};
+    std::array<size_t, PERF_EVENT_COUNT> m_groupIndices{};
+    size_t m_groupSize{};
+#endif
+    std::string m_unavailableReason{};
+};
+
+} // namespace Bench
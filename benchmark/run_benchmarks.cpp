@@ -0,0 +1,27 @@
+#include "benchmarks.hpp"
+#include "game_loop.hpp"
+#include "scaling.hpp"
+
+/*
+ * Usage: run_benchmarks [--filter name] [--warmup runs] [--reps runs] [--json results.json]
+ *                       [--baseline baseline.json] [--threshold 0.10] [--sweep] [--max-entities count]
+ *                       [--allocs] [--perf]
+ */
+int main(int argc, char **argv)
+{
+    auto options = Bench::parseOptions(argc, argv);
+
+    auto allBenchmarks = benchmarks;
+    auto gameLoops = GameLoop::getBenchmarks();
+    allBenchmarks.insert(allBenchmarks.end(), gameLoops.begin(), gameLoops.end());
+    if (!options.shouldSweep)
+        return Bench::run(allBenchmarks, options);
+
+    auto sweeps = Scaling::getBenchmarks(options.maxEntities);
+    allBenchmarks.insert(allBenchmarks.end(), sweeps.begin(), sweeps.end());
+
+    auto results = Bench::runAll(allBenchmarks, options);
+    Scaling::printScalingTables(results);
+
+    return Bench::report(results, options);
+}
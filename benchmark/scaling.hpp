@@ -0,0 +1,292 @@
+#pragma once
+
+#include "../test/helpers/components.hpp"
+#include "harness.hpp"
+
+/*
+ * Scaling sweeps run every operation across a range of entity counts, then across a range of component type
+ * counts, so the ns/item curves show where the working set falls out of cache and which operations grow
+ * superlinearly.
+ */
+namespace Scaling
+{
+
+using Bench::doNotOptimize;
+using Bench::State;
+
+inline constexpr size_t ENTITY_COUNTS[] = {1000, 10000, 100000, 1000000, 10000000};
+inline constexpr size_t TYPE_COUNTS[] = {1, 2, 4, 8, 16};
+// Component types used by the entity count sweep
+inline constexpr size_t SWEEP_TYPE_COUNT = 2;
+// Entity count used by the component type count sweep
+inline constexpr size_t SWEEP_ENTITY_COUNT = 100000;
+
+inline const std::vector<std::string> OPERATIONS{"create", "destroy", "get",   "gather",
+                                                 "group",  "update",  "clear", "remove"};
+
+template <size_t N> struct ScaleComp
+{
+    float x{};
+    float y{};
+};
+
+template <size_t... Is> inline void populate(CM &cm, size_t entityCount)
+{
+    for (EntityId eId = 1; eId <= entityCount; ++eId)
+        (cm.add<ScaleComp<Is>>(eId), ...);
+}
+
+/**
+ * @brief Build the benchmark of an operation over the entities having every component type
+ *
+ * @tparam Is - Indices of the component types
+ * @param Operation - One of OPERATIONS
+ * @param Entity count
+ *
+ * @return Benchmark function
+ */
+template <size_t... Is>
+[[nodiscard]] std::function<void(State &)> makeOperation(const std::string &operation, size_t entityCount)
+{
+    if (operation == "create")
+    {
+        return [=](State &state) {
+            CM cm{};
+            state.measure([&] { populate<Is...>(cm, entityCount); });
+        };
+    }
+
+    if (operation == "destroy")
+    {
+        return [=](State &state) {
+            CM cm{};
+            populate<Is...>(cm, entityCount);
+            state.measure([&] {
+                for (EntityId eId = 1; eId <= entityCount; ++eId)
+                    cm.remove<ScaleComp<Is>...>(eId);
+            });
+        };
+    }
+
+    if (operation == "get")
+    {
+        return [=](State &state) {
+            CM cm{};
+            populate<Is...>(cm, entityCount);
+            uint32_t count{};
+            state.measure([&] {
+                for (EntityId eId = 1; eId <= entityCount; ++eId)
+                {
+                    auto [comps] = cm.get<ScaleComp<0>>(eId);
+                    comps.inspect([&](const ScaleComp<0> &_) { count++; });
+                }
+            });
+            doNotOptimize(count);
+        };
+    }
+
+    if (operation == "gather")
+    {
+        return [=](State &state) {
+            CM cm{};
+            populate<Is...>(cm, entityCount);
+            uint32_t count{};
+            state.measure([&] {
+                for (EntityId eId = 1; eId <= entityCount; ++eId)
+                {
+                    auto compsTuple = cm.get<ScaleComp<Is>...>(eId);
+                    std::apply([&](auto &...comps) { (comps.inspect([&](auto &_) { count++; }), ...); },
+                               compsTuple);
+                }
+            });
+            doNotOptimize(count);
+        };
+    }
+
+    if (operation == "group")
+    {
+        return [=](State &state) {
+            CM cm{};
+            populate<Is...>(cm, entityCount);
+            uint32_t count{};
+            state.measure([&] {
+                auto group = cm.getGroup<ScaleComp<Is>...>();
+                group.each(
+                    [&](EntityId eId, auto &...comps) { (comps.inspect([&](auto &_) { count++; }), ...); });
+            });
+            doNotOptimize(count);
+        };
+    }
+
+    if (operation == "update")
+    {
+        return [=](State &state) {
+            CM cm{};
+            populate<Is...>(cm, entityCount);
+            state.measure([&] {
+                for (EntityId eId = 1; eId <= entityCount; ++eId)
+                {
+                    auto compsTuple = cm.get<ScaleComp<Is>...>(eId);
+                    std::apply(
+                        [&](auto &...comps) {
+                            (comps.mutate([&](auto &comp) {
+                                comp.x = 10.0f;
+                                comp.y = 10.0f;
+                            }),
+                             ...);
+                        },
+                        compsTuple);
+                }
+            });
+        };
+    }
+
+    if (operation == "clear")
+    {
+        return [=](State &state) {
+            CM cm{};
+            populate<Is...>(cm, entityCount);
+            state.measure([&] { cm.clear<ScaleComp<Is>...>(); });
+        };
+    }
+
+    // Removing whole entities walks every stored set for each entity
+    return [=](State &state) {
+        CM cm{};
+        populate<Is...>(cm, entityCount);
+        state.measure([&] {
+            for (EntityId eId = 1; eId <= entityCount; ++eId)
+                cm.remove(eId);
+        });
+    };
+}
+
+template <size_t... Is>
+[[nodiscard]] std::function<void(State &)> makeOperation(const std::string &operation, size_t entityCount,
+                                                         std::index_sequence<Is...>)
+{
+    return makeOperation<Is...>(operation, entityCount);
+}
+
+[[nodiscard]] inline std::function<void(State &)> makeOperation(const std::string &operation,
+                                                                size_t entityCount, size_t typeCount)
+{
+    switch (typeCount)
+    {
+    case 1:
+        return makeOperation(operation, entityCount, std::make_index_sequence<1>{});
+    case 2:
+        return makeOperation(operation, entityCount, std::make_index_sequence<2>{});
+    case 4:
+        return makeOperation(operation, entityCount, std::make_index_sequence<4>{});
+    case 8:
+        return makeOperation(operation, entityCount, std::make_index_sequence<8>{});
+    default:
+        return makeOperation(operation, entityCount, std::make_index_sequence<16>{});
+    }
+}
+
+[[nodiscard]] inline std::string formatCount(size_t count)
+{
+    if (count >= 1000000)
+        return std::to_string(count / 1000000) + "M";
+    if (count >= 1000)
+        return std::to_string(count / 1000) + "K";
+
+    return std::to_string(count);
+}
+
+[[nodiscard]] inline std::string getName(const std::string &operation, size_t entityCount, size_t typeCount)
+{
+    return "scale_" + operation + "_" + formatCount(entityCount) + "_" + std::to_string(typeCount) + "T";
+}
+
+/**
+ * @brief Build the benchmarks of both sweeps
+ *
+ * @param Largest entity count to sweep up to, the 10M entities sweep needs several GB of memory
+ *
+ * @return Benchmarks, grouped by operation
+ */
+[[nodiscard]] inline std::vector<Bench::Benchmark> getBenchmarks(size_t maxEntities)
+{
+    std::vector<Bench::Benchmark> benchmarks;
+    for (const auto &operation : OPERATIONS)
+    {
+        for (auto entityCount : ENTITY_COUNTS)
+        {
+            if (entityCount <= maxEntities)
+                benchmarks.push_back({getName(operation, entityCount, SWEEP_TYPE_COUNT), entityCount,
+                                      makeOperation(operation, entityCount, SWEEP_TYPE_COUNT)});
+        }
+
+        for (auto typeCount : TYPE_COUNTS)
+        {
+            // Already part of the entity count sweep
+            if (typeCount == SWEEP_TYPE_COUNT)
+                continue;
+
+            benchmarks.push_back({getName(operation, SWEEP_ENTITY_COUNT, typeCount), SWEEP_ENTITY_COUNT,
+                                  makeOperation(operation, SWEEP_ENTITY_COUNT, typeCount)});
+        }
+    }
+
+    return benchmarks;
+}
+
+template <typename Columns, typename GetName>
+inline void printTable(const std::string &title, const std::vector<Bench::Result> &results,
+                       const Columns &columns, GetName &&getColumnName)
+{
+    std::map<std::string, double> nsPerItem;
+    for (const auto &result : results)
+        nsPerItem[result.name] = result.nsPerItem();
+
+    std::cout << "\n" << std::left << std::setw(12) << title << std::right;
+    for (auto column : columns)
+        std::cout << std::setw(12) << column.first;
+    std::cout << "\n";
+
+    for (const auto &operation : OPERATIONS)
+    {
+        std::cout << std::left << std::setw(12) << operation << std::right << std::fixed
+                  << std::setprecision(2);
+        for (auto column : columns)
+        {
+            auto iter = nsPerItem.find(getColumnName(operation, column.second));
+            if (iter == nsPerItem.end())
+                std::cout << std::setw(12) << "-";
+            else
+                std::cout << std::setw(12) << iter->second;
+        }
+        std::cout << "\n";
+    }
+}
+
+/**
+ * @brief Print the ns/item of each operation, one row per operation and one column per size
+ *
+ * A flat row scales linearly, a rising row means the operation fell out of cache or grows superlinearly.
+ */
+inline void printScalingTables(const std::vector<Bench::Result> &results)
+{
+    std::vector<std::pair<std::string, size_t>> entityColumns;
+    for (auto entityCount : ENTITY_COUNTS)
+        entityColumns.emplace_back(formatCount(entityCount), entityCount);
+
+    std::vector<std::pair<std::string, size_t>> typeColumns;
+    for (auto typeCount : TYPE_COUNTS)
+        typeColumns.emplace_back(std::to_string(typeCount) + "T", typeCount);
+
+    printTable("ns/entity", results, entityColumns, [](const std::string &operation, size_t entityCount) {
+        return getName(operation, entityCount, SWEEP_TYPE_COUNT);
+    });
+    std::cout << "(" << SWEEP_TYPE_COUNT << " component types)\n";
+
+    printTable("ns/entity", results, typeColumns, [](const std::string &operation, size_t typeCount) {
+        return getName(operation, SWEEP_ENTITY_COUNT, typeCount);
+    });
+    std::cout << "(" << formatCount(SWEEP_ENTITY_COUNT) << " entities)\n";
+}
+
+} // namespace Scaling
@@ -0,0 +1,7 @@
+./build.sh
+
+cd build
+
+./benchmark/run_benchmarks "$@"
+
+cd ..
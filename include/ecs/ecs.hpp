@@ -14,9 +14,10 @@ template <typename EntityId, typename T> using Set = internal::SparseSet<EntityI
 
 /**
  * @brief The main entry point into the ECS.  Used to add, query, and remove components and component sets, as
- * well as perform other operations.
+ * well as perform other operations.  Custom tags are registered by listing them after the entity id type.
  */
-template <typename EntityId> using Manager = internal::EntityComponentManager<EntityId>;
+template <typename EntityId, typename... CustomTags>
+using Manager = internal::EntityComponentManager<EntityId, CustomTags...>;
 
 /**
  * @brief A grouping of entities which have all of the specified components.
@@ -28,7 +29,58 @@ template <typename EntityId, typename T> using Group = internal::Grouping<Entity
  * and provides access methods for the component data.
  */
 template <typename T> using Components = internal::ComponentsWrapper<T>;
+
+/**
+ * @brief Narrows a group down to the entities whose component of the specified type changed after a given tick
+ */
+template <typename T> using Changed = internal::Changed<T>;
+
+/**
+ * @brief Uniform grid over two coordinates of a NoStack-tagged component, used for range and neighbor queries
+ */
+template <typename EntityId, typename T, typename Coord>
+using SpatialIndex = internal::SpatialIndex<EntityId, T, Coord>;
+
+/**
+ * @brief Hash index from the values of a component field to the entities holding them
+ */
+template <typename EntityId, typename T, typename Field>
+using FieldIndex = internal::FieldIndex<EntityId, T, Field>;
+
+/**
+ * @brief Memory held by the component sets of a manager, per component type
+ */
+using MemoryStats = internal::MemoryStats;
+
+/**
+ * @brief Count, sum, min, max, and mean of an arithmetic component property
+ */
+template <typename Field> using FieldSummary = internal::FieldSummary<Field>;
+
+/**
+ * @brief Counts of hot-path events, recorded when compiled with ecs_enable_counters
+ */
+using Counters = internal::Counters;
+
+/**
+ * @brief Records the lifetime of a scope, eg: a system update, as a trace event when compiled with
+ * ecs_enable_tracing.  Compiles to nothing otherwise.
+ */
+using TraceScope = internal::TraceScope;
+
+/**
+ * @brief Owns the recorded trace events and writes them as Chrome trace-event JSON, for chrome://tracing or
+ * Perfetto
+ */
+using Tracer = internal::Tracer;
+
+/**
+ * @brief Counter used to record when components were last changed
+ */
+using Tick = internal::Tick;
 } // namespace ECS
 
 #undef ECS_LOG_WARNING
 #undef ECS_ASSERT
+#undef ECS_COUNT
+#undef ECS_TRACE_SCOPE
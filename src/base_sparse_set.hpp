@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core.hpp"
+#include "memory_stats.hpp"
+#include "observers.hpp"
 
 template <typename Id, typename T> class BaseSparseSet
 {
@@ -9,11 +11,16 @@ template <typename Id, typename T> class BaseSparseSet
     using BreakableEachFn = std::function<bool(Id, T &)>;
 
   public:
-    template <typename EntityId> friend class EntityComponentManager;
+    template <typename EntityId, typename... CustomTags> friend class EntityComponentManager;
     virtual ~BaseSparseSet() = default;
 
     virtual void erase(Id id) = 0;
+    virtual void clear() = 0;
+    virtual void prune() = 0;
     virtual size_t size() const = 0;
+    virtual ECS::internal::ComponentMemoryStats memoryStats(bool shouldWalkValues) const = 0;
+    virtual ECS::internal::Observers<Id> *getObservers() const = 0;
+    virtual void setObservers(ECS::internal::Observers<Id> *observers) = 0;
 
     template <typename Func> void each(Func fn)
     {
@@ -23,8 +30,4 @@ template <typename Id, typename T> class BaseSparseSet
     void eachWithEmpty(EachFn fn)
     {
     }
-
-    virtual void prune()
-    {
-    }
 };
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "components.hpp"
+#include "core.hpp"
+#include "sparse_set.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+template <typename EntityId> class BaseIndex
+{
+  public:
+    virtual ~BaseIndex() = default;
+};
+
+/**
+ * @brief Base for secondary indexes which are kept in sync with a single component set
+ *
+ * Indexes synchronise lazily, right before they are queried.  The component set appends the entities whose
+ * components are added, overwritten, mutated, or removed to logs as they change, so a synchronisation only
+ * re-indexes those entities, however large the set is.
+ *
+ * Changes made through the unsafe .unpack() method are not seen by indexes.
+ */
+template <typename EntityId, typename T> class ComponentIndex : public BaseIndex<EntityId>
+{
+  public:
+    using ComponentSet = SparseSet<EntityId, ComponentsWrapper<T>>;
+    using ComponentSetFn = std::function<ComponentSet *()>;
+
+    /**
+     * @brief Connect the index to the manager which owns the component set
+     *
+     * @param Function returning the component set, or nullptr while the set does not exist
+     */
+    void connect(ComponentSetFn componentSetFn)
+    {
+        m_componentSetFn = std::move(componentSetFn);
+    }
+
+    [[nodiscard]] std::vector<EntityId> &getRemovedLog()
+    {
+        return m_removedLog;
+    }
+
+    [[nodiscard]] std::vector<EntityId> &getChangedLog()
+    {
+        return m_changedLog;
+    }
+
+  protected:
+    /**
+     * @brief Re-index the entities which changed since the previous synchronisation
+     */
+    void sync()
+    {
+        for (auto eId : m_removedLog)
+            unindex(eId);
+        m_removedLog.clear();
+
+        auto cSetPtr = m_componentSetFn ? m_componentSetFn() : nullptr;
+        if (!m_isBuilt)
+        {
+            // Components which were there before the index are only in the set
+            m_isBuilt = true;
+            m_changedLog.clear();
+            if (cSetPtr)
+                cSetPtr->eachChanged(0, [&](EntityId eId, auto &comps) { index(eId, comps); });
+
+            return;
+        }
+
+        // An entity is logged once per change, re-indexing it again leaves the index as is
+        for (auto eId : m_changedLog)
+        {
+            // Components emptied by .remove() are still in the set until it is pruned
+            auto comps = cSetPtr ? cSetPtr->get(eId) : nullptr;
+            if (comps && *comps)
+                index(eId, *comps);
+            else
+                unindex(eId);
+        }
+        m_changedLog.clear();
+    }
+
+    virtual void index(EntityId eId, ComponentsWrapper<T> &comps) = 0;
+    virtual void unindex(EntityId eId) = 0;
+
+  private:
+    ComponentSetFn m_componentSetFn{};
+    bool m_isBuilt{false};
+    std::vector<EntityId> m_removedLog{};
+    std::vector<EntityId> m_changedLog{};
+};
+
+} // namespace internal
+} // namespace ECS
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "components_iterator.hpp"
+#include "field_summary.hpp"
 #include "macros.hpp"
+#include "memory_stats.hpp"
+#include "shared_pool.hpp"
 #include "tags.hpp"
 #include "utilities.hpp"
 #include <functional>
@@ -14,6 +17,43 @@ namespace internal
 
 template <typename T> using Transformer = std::function<T(T &)>;
 
+/**
+ * @brief Monotonic counter used to record when components were last changed
+ */
+using Tick = uint64_t;
+
+/**
+ * @brief Stamps changes with the manager's current tick and remembers the latest stamp given out
+ *
+ * Every component set owns one, so it can be told in constant time whether a set changed since a given tick.
+ */
+struct ChangeClock
+{
+    const Tick *tick{nullptr};
+    Tick lastChangeTick{0};
+    // Values of the set which hold no component, kept up to date so it can be read without a walk
+    size_t emptyValues{0};
+#ifdef ecs_enable_memory_resource
+    // Frame scratch arena of the manager, which derived wrappers allocate from once it is enabled
+    std::pmr::memory_resource *const *scratch{nullptr};
+    // Times the arena was released, which tells apart the derived wrappers of previous frames
+    const uint64_t *scratchResets{nullptr};
+#endif
+    // Component set owning the clock, and how to stamp the wrapper it stores for an entity
+    void *set{nullptr};
+    void (*stampEntity)(void *set, uint64_t entityId){nullptr};
+    // How to report a stamped entity to the observers of the set, only set while it is observed
+    void (*logChange)(void *set, uint64_t entityId){nullptr};
+    // Pool of the set which interns Shared-tagged components, for no other component
+    void *sharedPool{nullptr};
+
+    Tick stamp()
+    {
+        lastChangeTick = *tick;
+        return lastChangeTick;
+    }
+};
+
 struct DefaultComponent
 {
 };
@@ -42,6 +82,10 @@ enum class Transformation
  * are via the .mutate method This means every other method either provides const references or copies The
  * exception to this it the unsafe .unpack() method, which is provides raw pointers and is only accessible via
  * compiler flag.  This is an escape hatch and not intended for regular use
+ *
+ * When compiled with ecs_enable_memory_resource, the wrapper is allocator-aware, so a wrapper stored in a
+ * component set allocates its stacked, modified, and transformed components from the memory resource of the
+ * set
  */
 template <typename T> class ComponentsWrapper
 {
@@ -61,6 +105,44 @@ template <typename T> class ComponentsWrapper
         emplace(_args...);
     }
 
+#ifdef ecs_enable_memory_resource
+    using allocator_type = std::pmr::polymorphic_allocator<ComponentsWrapper>;
+
+    ComponentsWrapper(std::allocator_arg_t, const allocator_type &allocator, ComponentFlags _flag)
+        : m_modified(allocator), m_transformed(allocator), m_components(allocator)
+    {
+    }
+
+    template <typename... Args>
+    ComponentsWrapper(std::allocator_arg_t, const allocator_type &allocator, Args... _args)
+        : m_modified(allocator), m_transformed(allocator), m_components(allocator)
+    {
+        emplace(_args...);
+    }
+
+    ComponentsWrapper(std::allocator_arg_t, const allocator_type &allocator, ComponentsWrapper &&other)
+        : m_modified(std::move(other.m_modified), allocator),
+          m_transformed(std::move(other.m_transformed), allocator),
+          m_components(std::move(other.m_components), allocator), m_component(std::move(other.m_component)),
+          m_transformer(std::move(other.m_transformer)), m_clock(other.m_clock), m_entityId(other.m_entityId),
+          m_isDerived(other.m_isDerived), m_changeTick(other.m_changeTick)
+    {
+    }
+
+    ComponentsWrapper(std::allocator_arg_t, const allocator_type &allocator, const ComponentsWrapper &other)
+        : m_modified(other.m_modified, allocator), m_transformed(other.m_transformed, allocator),
+          m_components(other.m_components, allocator), m_component(other.m_component),
+          m_transformer(other.m_transformer), m_clock(other.m_clock), m_entityId(other.m_entityId),
+          m_isDerived(other.m_isDerived), m_changeTick(other.m_changeTick)
+    {
+    }
+
+    ComponentsWrapper(const ComponentsWrapper &) = default;
+    ComponentsWrapper(ComponentsWrapper &&) = default;
+    ComponentsWrapper &operator=(const ComponentsWrapper &) = default;
+    ComponentsWrapper &operator=(ComponentsWrapper &&) = default;
+#endif
+
     template <typename U> using Components = ComponentsWrapper<U>;
 
     /**
@@ -88,8 +170,19 @@ template <typename T> class ComponentsWrapper
         // TODO Task : Reevaluate this and transformation pipelines
         handleTransformations(Transformation::PRESERVE);
 
-        for (auto &comp : *this)
-            fn(comp);
+        if constexpr (Utilities::isShared<T>())
+        {
+            if (isComponent())
+            {
+                m_component.mutate(getSharedPool(), fn);
+                markChanged();
+                return;
+            }
+        }
+
+        forEach(fn);
+
+        markChanged();
     }
 
     /**
@@ -110,8 +203,7 @@ template <typename T> class ComponentsWrapper
 
         handleTransformations(behavior);
 
-        for (auto &comp : *this)
-            fn(comp);
+        forEach(fn);
     }
 
     /**
@@ -258,8 +350,7 @@ template <typename T> class ComponentsWrapper
         static_assert(std::is_convertible_v<std::invoke_result_t<Func, const T &>, bool>,
                       "Filter function must return bool.");
 
-        Components<T> newComps(ComponentFlags::EMPTY);
-        newComps.setTransformer(m_transformer);
+        Components<T> newComps = makeDerived();
 
         if (isEmpty())
             return std::move(newComps);
@@ -267,16 +358,10 @@ template <typename T> class ComponentsWrapper
         handleTransformations(behavior);
         bool shouldFilter = !shouldTransform(behavior);
 
-        for (auto &comp : *this)
-        {
-            if (!fn(comp))
-                continue;
-
-            if (shouldFilter)
-                newComps.modified().push_back(&comp);
-            else
-                newComps.transformed().push_back(T(comp));
-        }
+        forEach([&](T &comp) {
+            if (fn(comp))
+                pushDerived(newComps, comp, !shouldFilter);
+        });
 
         return std::move(newComps);
     }
@@ -297,8 +382,7 @@ template <typename T> class ComponentsWrapper
         static_assert(std::is_convertible_v<std::invoke_result_t<Func, const T &>, bool>,
                       "Find function must return bool.");
 
-        Components<T> newComps(ComponentFlags::EMPTY);
-        newComps.setTransformer(m_transformer);
+        Components<T> newComps = makeDerived();
 
         if (isEmpty())
             return std::move(newComps);
@@ -310,11 +394,7 @@ template <typename T> class ComponentsWrapper
             if (!fn(comp))
                 continue;
 
-            if (shouldTransform(behavior))
-                newComps.transformed().push_back(T(comp));
-            else
-                newComps.modified().push_back(&comp);
-
+            pushDerived(newComps, comp, shouldTransform(behavior));
             break;
         }
 
@@ -333,8 +413,7 @@ template <typename T> class ComponentsWrapper
      */
     [[nodiscard]] Components<T> first(Transformation behavior = Transformation::DEFAULT)
     {
-        Components<T> newComps(ComponentFlags::EMPTY);
-        newComps.setTransformer(m_transformer);
+        Components<T> newComps = makeDerived();
 
         if (isEmpty())
             return std::move(newComps);
@@ -343,10 +422,7 @@ template <typename T> class ComponentsWrapper
 
         auto &comp = *begin();
 
-        if (shouldTransform(behavior))
-            newComps.transformed().push_back(T(comp));
-        else
-            newComps.modified().push_back(&comp);
+        pushDerived(newComps, comp, shouldTransform(behavior));
 
         return std::move(newComps);
     }
@@ -363,20 +439,14 @@ template <typename T> class ComponentsWrapper
      */
     [[nodiscard]] Components<T> last(Transformation behavior = Transformation::DEFAULT)
     {
-        Components<T> newComps(ComponentFlags::EMPTY);
-        newComps.setTransformer(m_transformer);
+        Components<T> newComps = makeDerived();
 
         if (isEmpty())
             return std::move(newComps);
 
         handleTransformations(behavior);
 
-        auto &comp = *(end() - 1);
-
-        if (shouldTransform(behavior))
-            newComps.transformed().push_back(T(comp));
-        else
-            newComps.modified().push_back(&comp);
+        pushDerived(newComps, back(), shouldTransform(behavior));
 
         return std::move(newComps);
     }
@@ -398,30 +468,245 @@ template <typename T> class ComponentsWrapper
         static_assert(std::is_convertible_v<std::invoke_result_t<Func, const T &, const T &>, bool>,
                       "Sort function must return bool.");
 
-        Components<T> newComps(ComponentFlags::EMPTY);
-        newComps.setTransformer(m_transformer);
+        Components<T> newComps = makeDerived();
 
         if (isEmpty())
             return std::move(newComps);
 
         handleTransformations(behavior);
-        bool isTransformed = !shouldTransform(behavior);
+        bool shouldCopy = shouldTransform(behavior);
 
-        for (auto &comp : *this)
-        {
-            if (isTransformed)
-                newComps.transformed().push_back(T(comp));
-            else
-                newComps.modified().push_back(&comp);
-        }
+        forEach([&](T &comp) { pushDerived(newComps, comp, shouldCopy); });
 
-        if (newComps.size() > 1)
+        if (newComps.size() <= 1)
+            return std::move(newComps);
+
+        if (newComps.isModified())
             std::sort(newComps.modified().begin(), newComps.modified().end(),
                       [&](T *a, T *b) { return fn(*a, *b); });
+        else
+            std::sort(newComps.transformed().begin(), newComps.transformed().end(), fn);
 
         return std::move(newComps);
     }
 
+    /**
+     * @brief Get the first k components in the order of the sort function, without sorting the rest
+     *
+     * Keeps the k best components seen so far as a heap, so it runs in O(n log k), eg: the highest-priority
+     * buffs.  Equal components may come out in any order
+     *
+     * @param Number of components
+     * @param Sort function
+     * @param Transformation pipeline behavior
+     *
+     * @return New Components wrapper instance containing up to k sorted components
+     */
+    template <typename Func>
+    [[nodiscard]] Components<T> top(size_t k, Func &&fn, Transformation behavior = Transformation::DEFAULT)
+        requires std::invocable<Func, const T &, const T &>
+    {
+        static_assert(std::is_invocable_v<Func, const T &, const T &>,
+                      "Top function must take two const T& as arguments.");
+        static_assert(std::is_convertible_v<std::invoke_result_t<Func, const T &, const T &>, bool>,
+                      "Top function must return bool.");
+
+        Components<T> newComps = makeDerived();
+
+        if (isEmpty() || !k)
+            return std::move(newComps);
+
+        handleTransformations(behavior);
+
+        auto keepTop = [&](auto &heap) {
+            auto isBefore = [&](const auto &a, const auto &b) { return fn(deref(a), deref(b)); };
+            heap.reserve(std::min(k, size()));
+            forEach([&](T &comp) {
+                if (heap.size() == k)
+                {
+                    // The front of the heap is the worst of the k best
+                    if (!fn(comp, deref(heap.front())))
+                        return;
+
+                    std::pop_heap(heap.begin(), heap.end(), isBefore);
+                    heap.pop_back();
+                }
+
+                if constexpr (std::is_pointer_v<typename std::decay_t<decltype(heap)>::value_type>)
+                    heap.push_back(&comp);
+                else
+                    heap.push_back(T(comp));
+                std::push_heap(heap.begin(), heap.end(), isBefore);
+            });
+            std::sort_heap(heap.begin(), heap.end(), isBefore);
+        };
+
+        if (shouldTransform(behavior) || Utilities::isShared<T>())
+            keepTop(newComps.transformed());
+        else
+            keepTop(newComps.modified());
+
+        return std::move(newComps);
+    }
+
+    /**
+     * @brief Get the component with the smallest key, in a single pass
+     *
+     * @param Key function or T::Prop, the key must be comparable
+     * @param Transformation pipeline behavior
+     *
+     * @return New Components wrapper instance containing the first component with the smallest key
+     */
+    template <typename KeyFn>
+    [[nodiscard]] Components<T> minBy(KeyFn &&keyFn, Transformation behavior = Transformation::DEFAULT)
+        requires std::invocable<KeyFn, const T &>
+    {
+        return extremeBy(keyFn, std::less<>{}, behavior);
+    }
+
+    /**
+     * @brief Get the component with the largest key, in a single pass
+     *
+     * @param Key function or T::Prop, the key must be comparable
+     * @param Transformation pipeline behavior
+     *
+     * @return New Components wrapper instance containing the first component with the largest key
+     */
+    template <typename KeyFn>
+    [[nodiscard]] Components<T> maxBy(KeyFn &&keyFn, Transformation behavior = Transformation::DEFAULT)
+        requires std::invocable<KeyFn, const T &>
+    {
+        return extremeBy(keyFn, std::greater<>{}, behavior);
+    }
+
+    /**
+     * @brief Get the component which would be at index n if the components were sorted by ascending key
+     *
+     * Runs in O(n) on average.  .nthBy(0, key) is the same as .minBy(key)
+     *
+     * @param Index in the sorted order
+     * @param Key function or T::Prop, the key must be comparable
+     * @param Transformation pipeline behavior
+     *
+     * @return New Components wrapper instance containing the component, or empty when out of range
+     */
+    template <typename KeyFn>
+    [[nodiscard]] Components<T> nthBy(size_t n, KeyFn &&keyFn,
+                                      Transformation behavior = Transformation::DEFAULT)
+        requires std::invocable<KeyFn, const T &>
+    {
+        Components<T> newComps = makeDerived();
+
+        if (isEmpty() || n >= size())
+            return std::move(newComps);
+
+        handleTransformations(behavior);
+        bool shouldCopy = shouldTransform(behavior);
+
+        forEach([&](T &comp) { pushDerived(newComps, comp, shouldCopy); });
+
+        auto keepNth = [&](auto &derived) {
+            auto isLess = [&](const auto &a, const auto &b) {
+                return std::invoke(keyFn, deref(a)) < std::invoke(keyFn, deref(b));
+            };
+            std::nth_element(derived.begin(), derived.begin() + n, derived.end(), isLess);
+            std::swap(derived.front(), derived[n]);
+            derived.erase(derived.begin() + 1, derived.end());
+        };
+
+        if (newComps.isModified())
+            keepNth(newComps.modified());
+        else
+            keepNth(newComps.transformed());
+
+        return std::move(newComps);
+    }
+
+    /**
+     * @brief Get the count, sum, min, max, and mean of an arithmetic property in a single pass
+     *
+     * @param T::Prop
+     * @param Transformation pipeline behavior
+     *
+     * @return Summary of the property
+     */
+    template <typename Field>
+    [[nodiscard]] FieldSummary<Field> summarize(Field T::*field,
+                                                Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        FieldReducer<Field> reducer;
+        if (!isEmpty())
+        {
+            handleTransformations(behavior);
+            forEach([&](const T &comp) { reducer.add(comp.*field); });
+        }
+
+        return reducer.finish();
+    }
+
+    /**
+     * @brief Sum an arithmetic property, integral properties are summed in 64 bits
+     *
+     * @param T::Prop
+     * @param Transformation pipeline behavior
+     *
+     * @return Sum, 0 when there are no components
+     */
+    template <typename Field>
+    [[nodiscard]] typename FieldSummary<Field>::Sum sum(Field T::*field,
+                                                        Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        return summarize(field, behavior).sum;
+    }
+
+    /**
+     * @brief Get the smallest value of an arithmetic property
+     *
+     * @param T::Prop
+     * @param Transformation pipeline behavior
+     *
+     * @return Smallest value, if there are any components
+     */
+    template <typename Field>
+    [[nodiscard]] std::optional<Field> min(Field T::*field, Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        return summarize(field, behavior).min;
+    }
+
+    /**
+     * @brief Get the largest value of an arithmetic property
+     *
+     * @param T::Prop
+     * @param Transformation pipeline behavior
+     *
+     * @return Largest value, if there are any components
+     */
+    template <typename Field>
+    [[nodiscard]] std::optional<Field> max(Field T::*field, Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        return summarize(field, behavior).max;
+    }
+
+    /**
+     * @brief Get the mean of an arithmetic property
+     *
+     * @param T::Prop
+     * @param Transformation pipeline behavior
+     *
+     * @return Mean, if there are any components
+     */
+    template <typename Field>
+    [[nodiscard]] std::optional<double> mean(Field T::*field,
+                                             Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        return summarize(field, behavior).mean();
+    }
+
     /**
      * @brief Reduce multiple components into a single component
      *
@@ -446,8 +731,7 @@ template <typename T> class ComponentsWrapper
 
         handleTransformations(behavior);
 
-        for (auto &comp : *this)
-            fn(reduced, comp);
+        forEach([&](const T &comp) { fn(reduced, comp); });
 
         return reduced;
     }
@@ -479,6 +763,26 @@ template <typename T> class ComponentsWrapper
         return reduce(fn, T{}, behavior);
     }
 
+    /**
+     * @brief Get a lazy, readonly view of the components, to compose with the standard range adaptors
+     *
+     * Eg: comps.view() | std::views::filter(isBurning) | std::views::take(3)
+     * Nothing is materialized, the adaptors are evaluated on iteration.  The view is invalidated by any
+     * change to the components, the same as an iterator
+     *
+     * @param Transformation pipeline behavior
+     *
+     * @return View of const references to the components
+     */
+    [[nodiscard]] auto view(Transformation behavior = Transformation::DEFAULT)
+    {
+        handleTransformations(behavior);
+        auto comps = isEmpty() ? std::ranges::subrange(Iterator(nullptr), Iterator(nullptr))
+                               : std::ranges::subrange(begin(), end());
+
+        return comps | std::views::transform([](const T &comp) -> const T & { return comp; });
+    }
+
     /**
      * @brief Remove component if it evaluates to true
      *
@@ -498,7 +802,11 @@ template <typename T> class ComponentsWrapper
         if (isComponent())
         {
             if (fn(*component()))
+            {
                 m_component.reset();
+                markChanged();
+                countEmptied(false);
+            }
 
             return;
         }
@@ -506,6 +814,7 @@ template <typename T> class ComponentsWrapper
         if (!isComponents())
             return;
 
+        auto previousSize = components().size();
         for (auto iter = components().begin(); iter != components().end();)
         {
             if (fn(*iter))
@@ -513,6 +822,22 @@ template <typename T> class ComponentsWrapper
             else
                 ++iter;
         }
+
+        if (components().size() != previousSize)
+        {
+            markChanged();
+            countEmptied(false);
+        }
+    }
+
+    /**
+     * @brief Get the tick at which the components were last added, overwritten, or mutated
+     *
+     * @return Tick
+     */
+    [[nodiscard]] Tick getChangeTick() const
+    {
+        return m_changeTick;
     }
 
     /**
@@ -535,10 +860,13 @@ template <typename T> class ComponentsWrapper
     }
 #endif
 
-    template <typename EntityId> friend class EntityComponentManager;
+    template <typename EntityId, typename... CustomTags> friend class EntityComponentManager;
+    template <typename Id, typename Wrapper> friend class SparseSet;
 
   private:
     using Iterator = ComponentsIterator<T>;
+    // Pool owned by the component set, which only Shared-tagged components have
+    using SharedValues = std::conditional_t<Utilities::isShared<T>(), SharedPool<T>, void>;
 
     Iterator begin()
     {
@@ -582,14 +910,21 @@ template <typename T> class ComponentsWrapper
 
     template <typename... Args> void emplace_back(Args &&...args)
     {
+        bool wasEmpty = isEmpty();
         components().emplace_back(std::forward<Args>(args)...);
+        countEmptied(wasEmpty);
     }
 
     template <typename... Args> void emplace(Args... args)
     {
         if (!Utilities::shouldStack<T>())
         {
-            m_component.emplace(args...);
+            bool wasEmpty = isEmpty();
+            if constexpr (Utilities::isShared<T>())
+                m_component.emplace(getSharedPool(), args...);
+            else
+                m_component.emplace(args...);
+            countEmptied(wasEmpty);
             return;
         }
 
@@ -610,28 +945,191 @@ template <typename T> class ComponentsWrapper
      * Allows direct access to components stored within the components wrapper.
      * Be aware that this bypasses all safeguards in place when using the
      * regular approach to accessing components.
+     * Shared components are interned, so writes through the pointers would leak into other entities, and
+     * they are never unpacked.
      */
     [[nodiscard]] std::vector<T *> unpack()
     {
+        if constexpr (Utilities::isShared<T>())
+        {
+            ECS_LOG_WARNING("Shared components are interned, so", Utilities::getTypeName<T>(),
+                            "may not be written in place. Unpack failed!")
+            return {};
+        }
+
         std::vector<T *> vec;
-        for (auto &comp : *this)
-            vec.push_back(&comp);
+        forEach([&](T &comp) { vec.push_back(&comp); });
 
         return std::move(vec);
     }
 
+    /*
+     * Allows direct access to the contiguous storage of the components, without allocating.
+     * Derived wrappers, eg: from .filter(), point at components which are not contiguous, so their span is
+     * empty and .unpack() must be used instead.  The span is invalidated by any change to the components.
+     * Writes through the span are not stamped with the change tick, so indexes and .getGroup(sinceTick) miss
+     * them.  Shared components and transformed copies are never written in place, so their span is empty.
+     */
+    [[nodiscard]] std::span<T> unpackSpan()
+    {
+        if constexpr (Utilities::isShared<T>())
+        {
+            ECS_LOG_WARNING("Shared components are interned, so", Utilities::getTypeName<T>(),
+                            "may not be written in place. Unpack failed!")
+            return {};
+        }
+
+        switch (getArrangement())
+        {
+        case Arrangement::TRANSFORMED:
+            ECS_LOG_WARNING("Transformed copies of", Utilities::getTypeName<T>(),
+                            "would lose the writes. Unpack failed!")
+            return {};
+        case Arrangement::STACKED:
+            return components();
+        case Arrangement::NOT_STACKED:
+            return std::span<T>(component(), 1);
+        case Arrangement::MODIFIED:
+            ECS_LOG_WARNING("Components are not contiguous for", Utilities::getTypeName<T>(),
+                            "Unpack failed!")
+            return {};
+        default:
+            return {};
+        }
+    }
+
   private:
-    [[nodiscard]] std::vector<T *> &modified()
+    /*
+     * Calls the function on every component.  The arrangement is dispatched once, then each arrangement runs
+     * a tight loop over its contiguous storage instead of branching on every step of an iterator
+     */
+    template <typename Func> void forEach(Func &&fn)
+    {
+        switch (getArrangement())
+        {
+        case Arrangement::TRANSFORMED:
+            for (auto &comp : std::span<T>(transformed()))
+                fn(comp);
+            break;
+        case Arrangement::MODIFIED:
+            for (auto comp : std::span<T *>(modified()))
+                fn(*comp);
+            break;
+        case Arrangement::NOT_STACKED:
+            fn(*component());
+            break;
+        case Arrangement::STACKED:
+            for (auto &comp : std::span<T>(components()))
+                fn(comp);
+            break;
+        default:
+            break;
+        }
+    }
+
+    template <typename KeyFn, typename Compare>
+    [[nodiscard]] Components<T> extremeBy(KeyFn &keyFn, Compare isBefore, Transformation behavior)
+    {
+        Components<T> newComps = makeDerived();
+
+        if (isEmpty())
+            return std::move(newComps);
+
+        handleTransformations(behavior);
+
+        using Key = std::decay_t<std::invoke_result_t<KeyFn &, const T &>>;
+        T *best{nullptr};
+        std::optional<Key> bestKey;
+        forEach([&](T &comp) {
+            Key key = std::invoke(keyFn, std::as_const(comp));
+            if (bestKey && !isBefore(key, *bestKey))
+                return;
+
+            best = &comp;
+            bestKey = std::move(key);
+        });
+
+        pushDerived(newComps, *best, shouldTransform(behavior));
+
+        return std::move(newComps);
+    }
+
+    [[nodiscard]] static T &deref(T &comp)
+    {
+        return comp;
+    }
+
+    [[nodiscard]] static const T &deref(const T &comp)
+    {
+        return comp;
+    }
+
+    [[nodiscard]] static T &deref(T *comp)
+    {
+        return *comp;
+    }
+
+    [[nodiscard]] T &back()
+    {
+        switch (getArrangement())
+        {
+        case Arrangement::TRANSFORMED:
+            return transformed().back();
+        case Arrangement::MODIFIED:
+            return *modified().back();
+        case Arrangement::STACKED:
+            return components().back();
+        default:
+            return *component();
+        }
+    }
+
+    /*
+     * Wrappers derived by .filter(), .find(), .first(), .last(), and .sort() only live for the frame.  When
+     * compiled with ecs_enable_memory_resource, they allocate from the scratch arena of the manager once
+     * it is enabled with .reserveScratch()
+     */
+    [[nodiscard]] Components<T> makeDerived()
+    {
+#ifdef ecs_enable_memory_resource
+        auto scratch = m_clock && m_clock->scratch ? *m_clock->scratch : nullptr;
+        auto resource = scratch ? scratch : std::pmr::get_default_resource();
+        Components<T> newComps(std::allocator_arg, allocator_type(resource), ComponentFlags::EMPTY);
+#ifdef ecs_disable_asserts
+        newComps.m_scratchReset = scratch ? *m_clock->scratchResets : NOT_SCRATCH;
+#endif
+#else
+        Components<T> newComps(ComponentFlags::EMPTY);
+#endif
+        newComps.setTransformer(m_transformer);
+        newComps.deriveFrom(*this);
+
+        return newComps;
+    }
+
+    /*
+     * Derived wrappers normally point at the original components.  Shared components are always copied
+     * instead, so a mutation through a derived wrapper can never reach the interned value
+     */
+    void pushDerived(Components<T> &newComps, T &comp, bool shouldCopy)
+    {
+        if (shouldCopy || Utilities::isShared<T>())
+            newComps.transformed().push_back(T(comp));
+        else
+            newComps.modified().push_back(&comp);
+    }
+
+    [[nodiscard]] StorageVector<T *> &modified()
     {
         return m_modified;
     }
 
-    [[nodiscard]] std::vector<T> &transformed()
+    [[nodiscard]] StorageVector<T> &transformed()
     {
         return m_transformed;
     }
 
-    [[nodiscard]] std::vector<T> &components()
+    [[nodiscard]] StorageVector<T> &components()
     {
         return m_components;
     }
@@ -646,6 +1144,10 @@ template <typename T> class ComponentsWrapper
 
     [[nodiscard]] bool isEmpty() const
     {
+#if defined(ecs_enable_memory_resource) && defined(ecs_disable_asserts)
+        ECS_ASSERT(m_scratchReset == NOT_SCRATCH || m_scratchReset == *m_clock->scratchResets,
+                   "Derived wrapper of " + Utilities::getTypeName<T>() + " used after .resetScratch()")
+#endif
         return !isModified() && !isTransformed() && !isComponent() && !isComponents();
     }
 
@@ -674,11 +1176,105 @@ template <typename T> class ComponentsWrapper
         return !!m_transformer;
     }
 
+    /*
+     * @brief Whether a component was ever added to the wrapper, unlike a dummy inserted on a lookup miss
+     *
+     * The clock is only attached when a component is added or overwritten
+     */
+    [[nodiscard]] bool hasHeldComponents() const
+    {
+        return m_clock;
+    }
+
+    /*
+     * @brief Whether the wrapper is still as constructed with ComponentFlags::EMPTY
+     */
+    [[nodiscard]] bool isPristine() const
+    {
+        return !isModified() && !isTransformed() && !isComponents() && !isComponent() && !isTransformer() &&
+               !m_clock && !m_isDerived && !m_changeTick;
+    }
+
     void setTransformer(Transformer<T> transformerFn)
     {
         m_transformer = std::move(transformerFn);
     }
 
+    void setClock(ChangeClock *clock, uint64_t entityId)
+    {
+        m_clock = clock;
+        m_entityId = entityId;
+
+        if constexpr (Utilities::isShared<T>())
+            m_component.intern(getSharedPool());
+    }
+
+    [[nodiscard]] SharedPool<T> *getSharedPool() const
+    {
+        return m_clock ? static_cast<SharedPool<T> *>(m_clock->sharedPool) : nullptr;
+    }
+
+    /*
+     * Derived wrappers remember the entity of the wrapper owned by the component set rather than its address,
+     * since the set moves its wrappers around, so mutations made through them are recorded on the owning
+     * wrapper wherever it currently is
+     */
+    void deriveFrom(const ComponentsWrapper &source)
+    {
+        m_clock = source.m_clock;
+        m_entityId = source.m_entityId;
+        m_isDerived = true;
+        m_changeTick = source.m_changeTick;
+    }
+
+    /*
+     * Keeps the count of empty values of the owning set up to date when the wrapper is emptied or filled
+     */
+    void countEmptied(bool wasEmpty)
+    {
+        if (!m_clock || m_isDerived || wasEmpty == isEmpty())
+            return;
+
+        if (wasEmpty)
+            --m_clock->emptyValues;
+        else
+            ++m_clock->emptyValues;
+    }
+
+    void markChanged()
+    {
+        if (!m_clock)
+            return;
+
+        m_changeTick = m_clock->stamp();
+        if (m_isDerived)
+            m_clock->stampEntity(m_clock->set, m_entityId);
+        else if (m_clock->logChange)
+            m_clock->logChange(m_clock->set, m_entityId);
+    }
+
+    /*
+     * Same name as Utilities::getTypeName(), without copying it into a string
+     */
+    [[nodiscard]] static const char *getComponentTypeName()
+    {
+        return typeid(T).name();
+    }
+
+    /*
+     * Accumulate the memory held by this wrapper into the stats of its component set
+     */
+    void collectMemoryStats(ComponentMemoryStats &stats) const
+    {
+        bool isInline = isComponent() && !Utilities::isShared<T>();
+
+        stats.componentCount += isComponent() + m_components.size();
+        stats.transformers += isTransformer();
+        stats.wrapperOverheadBytes += sizeof(ComponentsWrapper) - (isInline ? sizeof(T) : 0);
+        stats.heapBytes += (m_components.capacity() + m_transformed.capacity()) * sizeof(T) +
+                           m_modified.capacity() * sizeof(T *);
+    }
+
     [[nodiscard]] bool shouldTransform(Transformation behavior)
     {
         if (!isTransformer() || isTransformed())
@@ -690,8 +1286,11 @@ template <typename T> class ComponentsWrapper
 
     void createTransformed()
     {
-        for (auto &comp : *this)
+        ECS_TRACE_SCOPE("transform")
+        forEach([&](T &comp) {
+            ECS_COUNT(transformations)
             transformed().push_back(m_transformer(comp));
+        });
     }
 
     void clearTransformed()
@@ -729,13 +1328,23 @@ template <typename T> class ComponentsWrapper
     }
 
   private:
-    std::vector<T *> m_modified;
-    std::vector<T> m_transformed;
-    std::vector<T> m_components;
-    std::optional<T> m_component;
+    StorageVector<T *> m_modified;
+    StorageVector<T> m_transformed;
+    StorageVector<T> m_components;
+    std::conditional_t<Utilities::isShared<T>(), SharedHandle<T>, std::optional<T>> m_component;
 
     Transformer<T> m_transformer;
 
+    ChangeClock *m_clock{nullptr};
+    uint64_t m_entityId{0};
+    bool m_isDerived{false};
+    Tick m_changeTick{0};
+#if defined(ecs_enable_memory_resource) && defined(ecs_disable_asserts)
+    static constexpr uint64_t NOT_SCRATCH = UINT64_MAX;
+    // Scratch arena release which the wrapper was derived after, when it allocates from the arena
+    uint64_t m_scratchReset{NOT_SCRATCH};
+#endif
+
 #ifdef ecs_allow_debug
   public:
 #else
@@ -1,5 +1,6 @@
 #include "core.hpp"
 #include "macros.hpp"
+#include "storage_vector.hpp"
 #include "utilities.hpp"
 
 enum class Arrangement
@@ -11,22 +12,33 @@ enum class Arrangement
     STACKED,
 };
 
+/*
+ * Satisfies std::forward_iterator, so a components wrapper can be used with the standard range adaptors
+ */
 template <typename T> class ComponentsIterator
 {
   public:
-    std::vector<T *>::iterator m_modifiedIter;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    ECS::internal::StorageVector<T *>::iterator m_modifiedIter;
     bool isModified{false};
 
-    std::vector<T>::iterator m_transformedIter;
+    ECS::internal::StorageVector<T>::iterator m_transformedIter;
     bool isTransformed{false};
 
-    std::vector<T>::iterator m_componentsIter;
+    ECS::internal::StorageVector<T>::iterator m_componentsIter;
     bool isComponents{false};
 
-    T *m_component;
+    T *m_component{nullptr};
     bool isComponent{false};
 
-    ComponentsIterator(std::vector<T *>::iterator _iter, Arrangement _arrangement)
+    ComponentsIterator() = default;
+
+    ComponentsIterator(ECS::internal::StorageVector<T *>::iterator _iter, Arrangement _arrangement)
     {
         switch (_arrangement)
         {
@@ -38,7 +50,7 @@ template <typename T> class ComponentsIterator
             ECS_LOG_WARNING("Arrangement not found for", ECS::internal::Utilities::getTypeName<T>(), "!")
         }
     }
-    ComponentsIterator(std::vector<T>::iterator _iter, Arrangement _arrangement)
+    ComponentsIterator(ECS::internal::StorageVector<T>::iterator _iter, Arrangement _arrangement)
     {
         switch (_arrangement)
         {
@@ -58,7 +70,7 @@ template <typename T> class ComponentsIterator
     {
     }
 
-    [[nodiscard]] T &operator*()
+    [[nodiscard]] T &operator*() const
     {
         ECS_ASSERT((isModified + isTransformed + isComponents + isComponent) == 1,
                    "Iterator has conflicting modes!")
@@ -93,6 +105,13 @@ template <typename T> class ComponentsIterator
         return *this;
     }
 
+    ComponentsIterator operator++(int)
+    {
+        auto previous = *this;
+        ++*this;
+        return previous;
+    }
+
     bool operator==(const ComponentsIterator &other) const
     {
         ECS_ASSERT((isModified + isTransformed + isComponents + isComponent) == 1,
@@ -4,12 +4,16 @@
 #include <array>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <ranges>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "core.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Counts of the hot-path events which cause churn, recorded when compiled with ecs_enable_counters
+ *
+ * Each thread records into its own counters, so managers used from different threads don't race.
+ */
+struct Counters
+{
+    // Growths of the sparse array of a component set
+    uint64_t sparseResizes{};
+    // Calls to prune a component set
+    uint64_t prunePasses{};
+    // Empty components erased by pruning, automatic or not
+    uint64_t prunedElements{};
+    // Empty components inserted when getting the components of an entity which has none
+    uint64_t dummyInserts{};
+    // Hash map lookups of component sets
+    uint64_t setLookups{};
+    // Checked casts of type-erased component sets
+    uint64_t dynamicCasts{};
+    // Components passed through a transformation function
+    uint64_t transformations{};
+};
+
+[[nodiscard]] inline Counters &getCounters()
+{
+    thread_local Counters counters{};
+    return counters;
+}
+
+} // namespace internal
+} // namespace ECS
@@ -1,9 +1,15 @@
 #pragma once
 
+#include "component_index.hpp"
 #include "components.hpp"
+#include "field_index.hpp"
 #include "grouping.hpp"
 #include "macros.hpp"
+#include "memory_stats.hpp"
+#include "observers.hpp"
 #include "sparse_set.hpp"
+#include "spatial_index.hpp"
+#include "tag_registry.hpp"
 #include "tags.hpp"
 #include "utilities.hpp"
 
@@ -15,24 +21,51 @@ namespace internal
 /**
  * @brief The main entry point into the ECS.  Used to add, query, and remove components and component sets, as
  * well as perform other operations.
+ *
+ * @tparam EntityId - Entity id type
+ * @tparam CustomTags - User-defined tags which component sets are indexed by, in addition to the built-in tags
  */
-template <typename EntityId> class EntityComponentManager
+template <typename EntityId, typename... CustomTags> class EntityComponentManager
 {
+    static_assert((!BuiltInTags::contains<CustomTags>() && ...), "Custom tags cannot be built-in tags!");
+
   private:
     template <typename T> using Components = ComponentsWrapper<T>;
     template <typename T> using ComponentSet = SparseSet<EntityId, Components<T>>;
     template <typename T> using ComponentSetMap = std::unordered_map<size_t, std::unique_ptr<T>>;
-    template <typename... Ts> using ComponentSetGroup = Grouping<EntityId, ComponentSet<Ts>...>;
+    template <typename... Ts>
+    using ComponentSetGroup = Grouping<EntityId, ComponentSet<QueriedComponentType<Ts>>...>;
 
     using ErasedComponent = Components<DefaultComponent>;
     using ErasedComponentSet = BaseSparseSet<EntityId, ErasedComponent>;
 
     using StoredComponents = ComponentSetMap<ErasedComponentSet>;
-    using StoredTags = std::unordered_map<size_t, std::unordered_set<size_t>>;
+
+    using Registry = RegisteredTags<CustomTags...>;
+    template <typename Tag> using EachTaggedFn = std::function<void(EntityId, Tag &)>;
+    template <typename Tag> using RemoveTaggedFn = std::function<bool(const Tag &)>;
+
+    /*
+     * A component set indexed by a tag, with type-erased operations which were instantiated for the
+     * component type when the set was created
+     */
+    template <typename Tag> struct TaggedSet
+    {
+        size_t componentHash;
+        void (*each)(ErasedComponentSet &, const EachTaggedFn<Tag> &);
+        void (*removeIf)(ErasedComponentSet &, const RemoveTaggedFn<Tag> &);
+    };
+    template <typename Tag> using TaggedSets = std::vector<TaggedSet<Tag>>;
+    using StoredTags = typename Registry::template Apply<TaggedSets>;
+
+    using ObserverFn = typename Observers<EntityId>::ObserverFn;
+    using StoredObservers = std::unordered_map<size_t, std::unique_ptr<Observers<EntityId>>>;
+    using StoredIndexes = std::unordered_map<size_t, std::vector<std::unique_ptr<BaseIndex<EntityId>>>>;
 
     template <typename T> using TransformationFn = std::function<T(EntityId, T)>;
     using StoredTransformationFn = std::function<DefaultComponent(EntityId, DefaultComponent &)>;
     using StoredTransformationFnMap = std::unordered_map<size_t, StoredTransformationFn>;
+    using StoredEmptyComponents = std::unordered_map<size_t, std::shared_ptr<void>>;
 
   public:
     /**
@@ -49,6 +82,78 @@ template <typename EntityId> class EntityComponentManager
         m_standardSetSize = setSize;
     }
 
+#ifdef ecs_enable_memory_resource
+    /**
+     * @brief Entity Component Manager constructor, with the memory resource which every component set and
+     * components wrapper allocates from
+     *
+     * Eg: a std::pmr::unsynchronized_pool_resource for locality and no fragmentation over long uptimes, or a
+     * std::pmr::monotonic_buffer_resource which is released all at once
+     *
+     * @param resource - Memory resource, which must outlive the manager
+     * @param reservedEntities - Number of entity ids to keep in reserve, starting from 1
+     * @param minSetSize - Minimum number of elements a set should contain
+     * @param setSize - Specific number of elements a set should contain in most cases
+     */
+    explicit EntityComponentManager(std::pmr::memory_resource *resource, EntityId reservedEntities = 10,
+                                    size_t minSetSize = 100, size_t setSize = 10024)
+        : m_resource(resource)
+    {
+        m_nextEntityId = static_cast<EntityId>(reservedEntities);
+        m_minSetSize = minSetSize;
+        m_standardSetSize = setSize;
+    }
+
+    /**
+     * @brief Get the memory resource which the component sets allocate from
+     */
+    [[nodiscard]] std::pmr::memory_resource *getMemoryResource() const
+    {
+        return m_resource;
+    }
+
+    /**
+     * @brief Release everything allocated from the frame scratch arena, eg: at the end of every frame
+     *
+     * Wrappers derived by .filter(), .find(), .first(), .last(), and .sort() allocate from the arena, so none
+     * may be kept past this call.  The arena keeps its initial buffer, so it only allocates from the memory
+     * resource once a frame outgrows the buffer.
+     */
+    void resetScratch()
+    {
+        if (m_scratchResource)
+            m_scratchResource->release();
+
+        ++m_scratchResets;
+    }
+
+    /**
+     * @brief Enable the frame scratch arena, or resize its initial buffer, which also releases everything
+     * allocated from it
+     *
+     * The arena is opt-in, since nothing allocated from it is freed until .resetScratch() is called.  Until
+     * then, derived wrappers allocate from the default memory resource.
+     *
+     * @param bytes - Size of the initial buffer, enough for the derived wrappers of a typical frame
+     */
+    void reserveScratch(size_t bytes = DEFAULT_SCRATCH_SIZE)
+    {
+        m_scratchResource.reset();
+        m_scratchBuffer.resize(bytes);
+        m_scratchResource.emplace(m_scratchBuffer.data(), m_scratchBuffer.size(), m_resource);
+        m_scratch = &*m_scratchResource;
+        ++m_scratchResets;
+    }
+
+    /**
+     * @brief Get the frame scratch arena which derived wrappers allocate from, nullptr until it is enabled
+     */
+    [[nodiscard]] std::pmr::memory_resource *getScratchResource()
+    {
+        return m_scratch;
+    }
+#endif
+
     /**
      * @brief Creates a new unique entity id
      *
@@ -59,6 +164,28 @@ template <typename EntityId> class EntityComponentManager
         return ++m_nextEntityId;
     }
 
+    /**
+     * @brief Advance the tick used to record component changes
+     *
+     * Components which are added, overwritten, or mutated are stamped with the current tick
+     *
+     * @return The new tick
+     */
+    Tick tick()
+    {
+        return ++m_tick;
+    }
+
+    /**
+     * @brief Get the tick used to record component changes
+     *
+     * @return Tick
+     */
+    [[nodiscard]] Tick getTick() const
+    {
+        return m_tick;
+    }
+
     /**
      * @brief Constructs and add a component to a set by entity id
      *
@@ -127,6 +254,23 @@ template <typename EntityId> class EntityComponentManager
         return {getComponents<T>(eId)...};
     }
 
+    /**
+     * @brief Get specified components for the entity without modifying any storage
+     *
+     * Unlike .get(), a missing component or component set is never created.  A shared empty wrapper is
+     * returned in its place instead, which evaluates to false.
+     *
+     * @tparam Ts - Component types
+     *
+     * @param Entity Id
+     *
+     * @return Entity component reference
+     */
+    template <typename... T> [[nodiscard]] std::tuple<Components<T> &...> tryGet(EntityId eId)
+    {
+        return {findComponents<T>(eId)...};
+    }
+
     /**
      * @brief Get a specified component for multiple entities
      *
@@ -146,6 +290,9 @@ template <typename EntityId> class EntityComponentManager
     /**
      * @brief Get a specified unique component
      *
+     * Unique component sets only ever hold a single slot, so the owner is read directly without iterating
+     * the set.  When there is no owner, a shared empty wrapper is returned and nothing is allocated.
+     *
      * @tparam T - Component type
      *
      * @return Container with the entity id and component
@@ -154,28 +301,40 @@ template <typename EntityId> class EntityComponentManager
     [[nodiscard]] std::pair<EntityId, Components<T> &> getUnique()
         requires(Utilities::isUnique<T>())
     {
-        auto &cSet = getComponentSet<T>();
-        ECS_ASSERT(Utilities::isUnique<T>(), Utilities::getTypeName<T>() + " is not a unique component!");
-
-        EntityId id{0};
-        Components<T> *compsPtr;
-        cSet.each([&](EntityId eId, auto &comps) {
-            if (id == 0)
-            {
-                id = eId;
-                compsPtr = &comps;
-            }
-            // Should not break the loop after the first element
-            // because auto-pruning will clean up dummy components
-            // as it iterates over them
-        });
+        auto cSetPtr = getComponentSetPtr<T>();
+        if (!cSetPtr)
+            return {0, getEmptyComponents<T>()};
 
-        if (compsPtr != nullptr)
-            return {id, *compsPtr};
+        auto [id, compsPtr] = cSetPtr->getFirst();
+        if (!compsPtr || !(*compsPtr))
+            return {0, cSetPtr->getMissing()};
 
-        // If the set is empty, create a dummy component for a fake entity
-        std::tuple<Components<T> &> compsTuple = get<T>(0);
-        return {0, std::get<0>(compsTuple)};
+        return {id, *compsPtr};
+    }
+
+    /**
+     * @brief Get the event components which were active before the last clear of the Event tag
+     *
+     * Event-tagged components are double-buffered.  Clearing the Event tag swaps the buffers, so systems can
+     * read the previous frame's events from this set while new events are added to the current one.
+     *
+     * @tparam T - Event component type
+     *
+     * @return Component set with the previous frame's events
+     */
+    template <typename T>
+    [[nodiscard]] ComponentSet<T> &getPreviousEvents()
+        requires(Utilities::isEvent<T>())
+    {
+        auto hash = getComponentHash<T>();
+        auto iter = m_previousEvents.find(hash);
+        if (iter == m_previousEvents.end())
+        {
+            getComponentSet<T>();
+            iter = m_previousEvents.find(hash);
+        }
+
+        return castErasedTo<T>(iter);
     }
 
     /**
@@ -188,7 +347,14 @@ template <typename EntityId> class EntityComponentManager
     template <typename T, typename... Ts> [[nodiscard]] const std::vector<EntityId> getEntityIds()
     {
         if constexpr (sizeof...(Ts) == 0)
+        {
+#ifdef ecs_enable_memory_resource
+            const auto &ids = getComponentSet<T>(m_minSetSize).getIds();
+            return std::vector<EntityId>(ids.begin(), ids.end());
+#else
             return getComponentSet<T>(m_minSetSize).getIds();
+#endif
+        }
 
         auto &cSet = getComponentSet<T>();
         std::unordered_set<EntityId> ids(cSet.getIds().begin(), cSet.getIds().end());
@@ -207,24 +373,30 @@ template <typename EntityId> class EntityComponentManager
     /**
      * @brief Find overlapping entities for the specified types
      *
-     * Creates a group of entities with all of the specified types in common
+     * Creates a group of entities with all of the specified types in common.  Types wrapped in Changed<T>
+     * only match entities whose component changed after the specified tick.  Entities keep the order of the
+     * first component set, so a set ordered with .sortBy() or .sortAs() is iterated sequentially.
      *
      * @tparam Ts - Component types
      *
+     * @param Tick - Exclusive bound, changes stamped at this very tick are not matched.  Reading .getTick()
+     * right before calling .tick() matches every change made after the call
+     *
      * @return Grouping of entities
      */
     // CHANGE NAME: group() , groupCommon() , groupOverlapping() , groupShared() ?
-    template <typename... Ts> ComponentSetGroup<Ts...> getGroup()
+    template <typename... Ts> ComponentSetGroup<Ts...> getGroup(Tick sinceTick = 0)
     {
+        ECS_TRACE_SCOPE("getGroup")
         bool shouldBreak{};
-        std::tuple<ComponentSet<Ts> *...> sets{};
-        std::unordered_set<EntityId> ids{};
+        std::tuple<ComponentSet<QueriedComponentType<Ts>> *...> sets{};
+        std::vector<EntityId> ids{};
         (
             [&]() {
                 if (shouldBreak)
                     return;
 
-                auto cSet = getComponentSetPtr<Ts>();
+                auto cSet = getComponentSetPtr<QueriedComponentType<Ts>>();
                 if (!cSet)
                 {
                     ids.clear();
@@ -234,8 +406,8 @@ template <typename EntityId> class EntityComponentManager
 
                 if (ids.empty())
                 {
-                    auto &entityIds = cSet->getIds();
-                    ids = std::unordered_set<EntityId>(entityIds.begin(), entityIds.end());
+                    const auto &setIds = cSet->getIds();
+                    ids.assign(setIds.begin(), setIds.end());
                 }
                 else
                 {
@@ -243,12 +415,17 @@ template <typename EntityId> class EntityComponentManager
                     // Maybe do it on .contains(id) call instead, for each set element
                     // which contains but evaluates to falsy
                     cSet->prune();
-                    for (auto iter = ids.begin(); iter != ids.end();)
-                        iter = cSet->contains(*iter) ? std::next(iter) : ids.erase(iter);
+                    std::erase_if(ids, [&](EntityId eId) { return !cSet->contains(eId); });
+                }
+
+                if constexpr (QueriedComponent<Ts>::isChanged)
+                {
+                    std::erase_if(ids,
+                                  [&](EntityId eId) { return cSet->get(eId)->getChangeTick() <= sinceTick; });
                 }
 
                 if (!ids.empty())
-                    std::get<ComponentSet<Ts> *>(sets) = cSet;
+                    std::get<ComponentSet<QueriedComponentType<Ts>> *>(sets) = cSet;
                 else
                     shouldBreak = true;
             }(),
@@ -257,7 +434,7 @@ template <typename EntityId> class EntityComponentManager
         if (ids.empty())
             return ComponentSetGroup<Ts...>();
 
-        return ComponentSetGroup<Ts...>(std::vector<EntityId>(ids.begin(), ids.end()), std::move(sets));
+        return ComponentSetGroup<Ts...>(std::move(ids), std::move(sets));
     }
 
     /**
@@ -317,6 +494,7 @@ template <typename EntityId> class EntityComponentManager
      */
     template <typename... Ts> void clear()
     {
+        ECS_TRACE_SCOPE("clear")
 #ifdef ecs_allow_debug
         (debugCheckRequired<Ts>("Clear"), ...);
 #endif
@@ -387,7 +565,53 @@ template <typename EntityId> class EntityComponentManager
      */
     template <typename... Ts> void prune()
     {
-        (prune<Ts>(getComponentHash<Ts>()), ...);
+        ECS_TRACE_SCOPE("prune")
+        (
+            [&]() {
+                if constexpr (Registry::template contains<Ts>())
+                    pruneComponentsByTag<Ts>();
+                else
+                    prune<Ts>(getComponentHash<Ts>());
+            }(),
+            ...);
+    }
+
+    /**
+     * @brief Iterate over every component which has the specified tag, across all tagged component sets
+     *
+     * @tparam Tag - Built-in or custom tag
+     *
+     * @param Function which accepts the entity id and a reference to the tagged component
+     */
+    template <typename Tag> void each(EachTaggedFn<Tag> fn)
+    {
+        static_assert(Registry::template contains<Tag>(), "Tag is not registered with the manager!");
+
+        for (auto &taggedSet : getTaggedSets<Tag>())
+        {
+            auto iter = getStoredComponents().find(taggedSet.componentHash);
+            if (iter != getStoredComponents().end())
+                taggedSet.each(getSetFromIterator(iter), fn);
+        }
+    }
+
+    /**
+     * @brief Remove every component with the specified tag which passes the check
+     *
+     * @tparam Tag - Built-in or custom tag
+     *
+     * @param Removal check function
+     */
+    template <typename Tag> void removeIf(RemoveTaggedFn<Tag> fn)
+    {
+        static_assert(Registry::template contains<Tag>(), "Tag is not registered with the manager!");
+
+        for (auto &taggedSet : getTaggedSets<Tag>())
+        {
+            auto iter = getStoredComponents().find(taggedSet.componentHash);
+            if (iter != getStoredComponents().end())
+                taggedSet.removeIf(getSetFromIterator(iter), fn);
+        }
     }
 
     /**
@@ -401,10 +625,174 @@ template <typename EntityId> class EntityComponentManager
         m_transformationMap.emplace(getComponentHash<T>(), std::move(casted));
     }
 
+    /**
+     * @brief Observe the entities which have the specified component added
+     *
+     * Ids are batched and passed to the observer as a single list by .flushObservers()
+     *
+     * @tparam T - Component type
+     *
+     * @param Observer function which accepts a container of entity ids
+     */
+    template <typename T> void onAdd(ObserverFn observerFn)
+    {
+        getObservers<T>().onAdd(std::move(observerFn));
+    }
+
+    /**
+     * @brief Observe the entities which have the specified component removed
+     *
+     * Ids are batched and passed to the observer as a single list by .flushObservers()
+     *
+     * @tparam T - Component type
+     *
+     * @param Observer function which accepts a container of entity ids
+     */
+    template <typename T> void onRemove(ObserverFn observerFn)
+    {
+        getObservers<T>().onRemove(std::move(observerFn));
+    }
+
+    /**
+     * @brief Observe the entities which have the specified component overwritten
+     *
+     * Ids are batched and passed to the observer as a single list by .flushObservers()
+     *
+     * @tparam T - Component type
+     *
+     * @param Observer function which accepts a container of entity ids
+     */
+    template <typename T> void onOverwrite(ObserverFn observerFn)
+    {
+        getObservers<T>().onOverwrite(std::move(observerFn));
+    }
+
+    /**
+     * @brief Pass every batch of observed entity ids to the observers and reset the batches
+     *
+     * Intended to be called once per frame
+     */
+    void flushObservers()
+    {
+        for (auto &[_, observers] : m_observerMap)
+            observers->flush();
+    }
+
+    /**
+     * @brief Get the spatial index over two coordinates of a NoStack-tagged component, creating it on first use
+     *
+     * The index keeps itself in sync with the component set, so the returned reference can be kept and
+     * queried at any time.  Requesting an existing index returns it as is, whatever the cell size.
+     *
+     * @tparam T - Component type
+     * @tparam Coord - Coordinate type
+     *
+     * @param T::x - Member holding the x coordinate
+     * @param T::y - Member holding the y coordinate
+     * @param Cell size - Width and height of a grid cell, ideally close to the typical query radius
+     *
+     * @return Spatial index
+     */
+    template <typename T, typename Coord>
+    SpatialIndex<EntityId, T, Coord> &spatialIndex(Coord T::*x, Coord T::*y,
+                                                   std::type_identity_t<Coord> cellSize)
+    {
+        using Index = SpatialIndex<EntityId, T, Coord>;
+        for (auto &index : m_indexMap[getComponentHash<T>()])
+        {
+            auto existing = dynamic_cast<Index *>(index.get());
+            if (existing && existing->isIndexing(x, y))
+                return *existing;
+        }
+
+        return registerIndex<T>(std::make_unique<Index>(x, y, cellSize));
+    }
+
+    /**
+     * @brief Get the hash index over a field of a component, creating it on first use
+     *
+     * The index keeps itself in sync with the component set through adds, overwrites, mutations, and removals,
+     * so the returned reference can be kept and queried at any time.
+     *
+     * @tparam T - Component type
+     * @tparam Field - Field type
+     *
+     * @param T::field - Member holding the indexed value
+     *
+     * @return Field index
+     */
+    template <typename T, typename Field> FieldIndex<EntityId, T, Field> &index(Field T::*field)
+    {
+        using Index = FieldIndex<EntityId, T, Field>;
+        for (auto &index : m_indexMap[getComponentHash<T>()])
+        {
+            auto existing = dynamic_cast<Index *>(index.get());
+            if (existing && existing->isIndexing(field))
+                return *existing;
+        }
+
+        return registerIndex<T>(std::make_unique<Index>(field));
+    }
+
+    /**
+     * @brief Measure the memory held by the component sets, per component type
+     *
+     * Event components include their previous-frame buffer.  Walking the components is linear in their
+     * number, while skipping it only reads the set sizes and capacities, which is cheap enough to sample every
+     * frame for telemetry.  Component counts, transformers, wrapper overhead, and heap bytes are only
+     * measured by the walk, while empty wrappers are counted by the sets as they change.
+     *
+     * @param Whether or not to walk the components
+     *
+     * @return Memory stats
+     */
+    [[nodiscard]] MemoryStats memoryStats(bool shouldWalkComponents = true)
+    {
+        MemoryStats stats;
+        memoryStats(stats, shouldWalkComponents);
+
+        return stats;
+    }
+
+    /**
+     * @brief Measure the memory held by the component sets into existing stats, replacing their content
+     *
+     * Does not allocate once the stats have held as many component types, so it suits sampling every frame.
+     *
+     * @param Stats to fill
+     * @param Whether or not to walk the components
+     */
+    void memoryStats(MemoryStats &stats, bool shouldWalkComponents = true)
+    {
+        stats.components.clear();
+        stats.components.reserve(getStoredComponents().size());
+        for (auto iter = getStoredComponents().begin(); iter != getStoredComponents().end(); ++iter)
+        {
+            auto componentStats = getSetFromIterator(iter).memoryStats(shouldWalkComponents);
+
+            auto previousIter = m_previousEvents.find(iter->first);
+            if (previousIter != m_previousEvents.end())
+                componentStats += getSetFromIterator(previousIter).memoryStats(shouldWalkComponents);
+
+            stats.components.push_back(componentStats);
+        }
+    }
+
     EntityComponentManager(const EntityComponentManager &) = delete;
     EntityComponentManager &operator=(const EntityComponentManager &) = delete;
 
   private:
+    template <typename T, typename Index> Index &registerIndex(std::unique_ptr<Index> index)
+    {
+        auto &indexRef = *index;
+        getObservers<T>().addRemovedLog(&indexRef.getRemovedLog());
+        getObservers<T>().addChangedLog(&indexRef.getChangedLog());
+        indexRef.connect([this]() { return getComponentSetPtr<T>(); });
+        m_indexMap[getComponentHash<T>()].push_back(std::move(index));
+
+        return indexRef;
+    }
+
     template <typename T> void removeIds(const std::vector<EntityId> &ids)
     {
         auto cSetPtr = getComponentSetPtr<T>();
@@ -427,16 +815,31 @@ template <typename EntityId> class EntityComponentManager
     {
         for (auto iter = getStoredComponents().begin(); iter != getStoredComponents().end(); ++iter)
             getSetFromIterator(iter).erase(eId);
+
+        for (auto iter = m_previousEvents.begin(); iter != m_previousEvents.end(); ++iter)
+            getSetFromIterator(iter).erase(eId);
     }
 
     template <typename T, typename... Args> void addUnique(EntityId eId, Args... args)
     {
+        auto &cSet = getComponentSet<T>(m_minSetSize);
+
+        // Drop an owner whose components were all removed so the slot can be reclaimed
+        cSet.prune();
+        if (cSet.size())
+        {
+            ECS_LOG_WARNING(Utilities::getTypeName<T>(), "is already owned by", cSet.getFirst().first,
+                            "Add failed!");
+            return;
+        }
+
+        cSet.unlock();
         addComponent<T>(eId, args...);
-        getComponentSet<T>(m_minSetSize).lock();
+        cSet.lock();
     }
 
     template <typename T, typename... Args>
-    void overwriteUnique(EntityId eId, ComponentSet<T> cSet, Args... args)
+    void overwriteUnique(EntityId eId, ComponentSet<T> &cSet, Args... args)
     {
         auto [uniqueId, _] = getUnique<T>();
 
@@ -462,6 +865,7 @@ template <typename EntityId> class EntityComponentManager
     {
         static_assert(!(Utilities::isStacked<T>() && Utilities::isNotStacked<T>()),
                       "Conflicting tags detected!");
+        static_assert(!(Utilities::isStacked<T>() && Utilities::isShared<T>()), "Conflicting tags detected!");
     }
 #endif
 
@@ -474,7 +878,7 @@ template <typename EntityId> class EntityComponentManager
     auto getComponentsHelper(auto &cSet, Id id, Rest... rest)
     {
         Components<T> &firstComponent = getOrCreateComponent<T>(cSet, id);
-        std::tuple<Components<T> &> restComponents = getComponentsHelper<T>(cSet, rest...);
+        auto restComponents = getComponentsHelper<T>(cSet, rest...);
 
         return std::tuple_cat(std::tuple<Components<T> &>(firstComponent), restComponents);
     }
@@ -494,7 +898,7 @@ template <typename EntityId> class EntityComponentManager
         auto &cSet = castErasedTo<T>(iter);
         cSet.prune();
         if (!cSet.size())
-            getStoredComponents().erase(iter);
+            eraseComponentSet(compHash);
     }
 
     template <typename T> ComponentSet<T> &getComponentSet()
@@ -504,6 +908,7 @@ template <typename EntityId> class EntityComponentManager
 
     template <typename T> ComponentSet<T> *getComponentSetPtr()
     {
+        ECS_COUNT(setLookups)
         auto hash = getComponentHash<T>();
         auto iter = getStoredComponents().find(hash);
         if (iter == getStoredComponents().end())
@@ -514,6 +919,7 @@ template <typename EntityId> class EntityComponentManager
 
     template <typename T> ComponentSet<T> &getComponentSet(size_t maxSize)
     {
+        ECS_COUNT(setLookups)
         auto hash = getComponentHash<T>();
         auto iter = getStoredComponents().find(hash);
         if (iter == getStoredComponents().end())
@@ -533,6 +939,19 @@ template <typename EntityId> class EntityComponentManager
         return getOrCreateComponent<T>(cSet, eId);
     }
 
+    template <typename T> Components<T> &findComponents(EntityId eId)
+    {
+        auto cSetPtr = getComponentSetPtr<T>();
+        if (!cSetPtr)
+            return getEmptyComponents<T>();
+
+        auto compsPtr = cSetPtr->get(eId);
+        if (!compsPtr)
+            return cSetPtr->getMissing();
+
+        return *compsPtr;
+    }
+
     template <typename T> Components<T> &getOrCreateComponent(ComponentSet<T> &cSet, EntityId eId)
     {
 #ifdef ecs_allow_debug
@@ -541,22 +960,38 @@ template <typename EntityId> class EntityComponentManager
         auto comps = cSet.get(eId);
         if (!comps)
         {
-            Components<T> dummy{Components<T>::ComponentFlags::EMPTY};
+            // Locked sets keep a single slot, so they are never padded with dummy components
             if (cSet.isLocked())
-            {
-                cSet.unlock();
-                cSet.insert(eId, std::move(dummy));
-                cSet.lock();
-            }
-            else
-                cSet.insert(eId, std::move(dummy));
+                return cSet.getMissing();
 
+            ECS_COUNT(dummyInserts)
+            cSet.insert(eId, Components<T>{Components<T>::ComponentFlags::EMPTY});
             comps = cSet.get(eId);
         }
 
         return *comps;
     }
 
+    /*
+     * @brief Empty wrapper returned for lookups which must not insert into a set
+     *
+     * Used when the component set does not exist, otherwise the set's own missing value is returned.  There
+     * is one per manager and component type, and it is reset on every call so whatever was done through a
+     * previous miss does not leak into the next one.
+     */
+    template <typename T> Components<T> &getEmptyComponents()
+    {
+        auto &erased = m_emptyComponents[getComponentHash<T>()];
+        if (!erased)
+            erased = std::make_shared<Components<T>>(Components<T>::ComponentFlags::EMPTY);
+
+        auto &empty = *static_cast<Components<T> *>(erased.get());
+        if (!empty.isPristine())
+            empty = Components<T>{Components<T>::ComponentFlags::EMPTY};
+
+        return empty;
+    }
+
     template <typename T, typename... Args> void addComponent(EntityId eId, Args... args)
     {
         ComponentSet<T> &cSet = getComponentSet<T>();
@@ -571,6 +1006,9 @@ template <typename EntityId> class EntityComponentManager
                 return;
 
             setTransformer(eId, *newCompsPtr);
+            newCompsPtr->setClock(&cSet.getClock(), eId);
+            newCompsPtr->markChanged();
+            notifyAdded(eId, cSet);
             return;
         }
 
@@ -582,8 +1020,17 @@ template <typename EntityId> class EntityComponentManager
             return;
         }
 
+        comps->setClock(&cSet.getClock(), eId);
         comps->emplace_back(args...);
         setTransformer(eId, *comps);
+        comps->markChanged();
+        notifyAdded(eId, cSet);
+    }
+
+    template <typename T> void notifyAdded(EntityId eId, ComponentSet<T> &cSet)
+    {
+        if (auto observers = cSet.getObservers())
+            observers->added(eId);
     }
 
     template <typename T, typename... Args>
@@ -597,7 +1044,36 @@ template <typename EntityId> class EntityComponentManager
         }
 
         auto newComps = Components<T>(args...);
+        newComps.setClock(&cSet.getClock(), eId);
+        newComps.markChanged();
         cSet.overwrite(eId, std::move(newComps));
+
+        if (auto observers = cSet.getObservers())
+            observers->overwritten(eId);
+    }
+
+    template <typename T> Observers<EntityId> &getObservers()
+    {
+        auto hash = getComponentHash<T>();
+        auto iter = m_observerMap.find(hash);
+        if (iter != m_observerMap.end())
+            return *iter->second;
+
+        auto &observers = *m_observerMap.emplace(hash, std::make_unique<Observers<EntityId>>()).first->second;
+
+        if (auto cSetPtr = getComponentSetPtr<T>())
+            cSetPtr->setObservers(&observers);
+
+        return observers;
+    }
+
+    template <typename T> [[nodiscard]] std::unique_ptr<ComponentSet<T>> makeComponentSet(size_t maxSize)
+    {
+#ifdef ecs_enable_memory_resource
+        return std::make_unique<ComponentSet<T>>(maxSize, m_standardSetSize, m_resource);
+#else
+        return std::make_unique<ComponentSet<T>>(maxSize, m_standardSetSize);
+#endif
     }
 
     template <typename T> void createComponentSet(size_t maxSize)
@@ -607,49 +1083,126 @@ template <typename EntityId> class EntityComponentManager
 #endif
 
         auto componentHash = getComponentHash<T>();
-        auto cSet = std::make_unique<ComponentSet<T>>(maxSize, m_standardSetSize);
+        auto observersIter = m_observerMap.find(componentHash);
+        auto observers = observersIter != m_observerMap.end() ? observersIter->second.get() : nullptr;
+
+        auto cSet = makeComponentSet<T>(maxSize);
+        cSet->setObservers(observers);
+        cSet->getClock().tick = &m_tick;
+#ifdef ecs_enable_memory_resource
+        cSet->getClock().scratch = &m_scratch;
+        cSet->getClock().scratchResets = &m_scratchResets;
+#endif
         getStoredComponents().insert({componentHash, std::move(cSet)});
 
-        auto tagHashes = getTagHashes<T>();
-
-        for (const auto &tagHash : tagHashes)
+        if constexpr (Utilities::isEvent<T>())
         {
-            if (!tagHash)
-                continue;
+            auto backBuffer = makeComponentSet<T>(maxSize);
+            backBuffer->getClock().tick = &m_tick;
+#ifdef ecs_enable_memory_resource
+            backBuffer->getClock().scratch = &m_scratch;
+            backBuffer->getClock().scratchResets = &m_scratchResets;
+#endif
+            m_previousEvents.try_emplace(componentHash, std::move(backBuffer));
+        }
+
+        Registry::each([&]<typename Tag>() {
+            if constexpr (Utilities::isBase<T, Tag>())
+                getTaggedSets<Tag>().push_back({componentHash, &eachTagged<T, Tag>, &removeTagged<T, Tag>});
+        });
+    }
 
-            auto tagIter = m_tagMap.find(tagHash);
-            if (tagIter == m_tagMap.end())
-                tagIter = m_tagMap.emplace(tagHash, std::unordered_set<size_t>()).first;
+    template <typename T, typename Tag>
+    static void eachTagged(ErasedComponentSet &erasedSet, const EachTaggedFn<Tag> &fn)
+    {
+        static_cast<ComponentSet<T> &>(erasedSet).each([&](EntityId eId, Components<T> &comps) {
+            comps.mutate([&](T &component) { fn(eId, component); });
+        });
+    }
+
+    template <typename T, typename Tag>
+    static void removeTagged(ErasedComponentSet &erasedSet, const RemoveTaggedFn<Tag> &fn)
+    {
+        static_cast<ComponentSet<T> &>(erasedSet).each([&](EntityId eId, Components<T> &comps) {
+            comps.remove([&](const T &component) { return fn(component); });
+        });
+    }
+
+    template <typename Tag> TaggedSets<Tag> &getTaggedSets()
+    {
+        return std::get<TaggedSets<Tag>>(m_tagMap);
+    }
 
-            tagIter->second.insert(componentHash);
+    /*
+     * @brief Destroy a component set and drop it from the tag index
+     *
+     * Event sets are only emptied, so neither buffer has to be reallocated when the events come back.
+     */
+    void eraseComponentSet(size_t componentHash)
+    {
+        if (m_previousEvents.contains(componentHash))
+        {
+            auto iter = getStoredComponents().find(componentHash);
+            if (iter != getStoredComponents().end())
+                getSetFromIterator(iter).clear();
+
+            return;
         }
+
+        if (!getStoredComponents().erase(componentHash))
+            return;
+
+        Registry::each([&]<typename Tag>() {
+            std::erase_if(getTaggedSets<Tag>(), [&](const TaggedSet<Tag> &taggedSet) {
+                return taggedSet.componentHash == componentHash;
+            });
+        });
     }
 
     template <typename... Ts> void clearComponents()
     {
         (
             [&]() {
-                // TODO Task : Update to support more tags
                 if constexpr (std::is_same_v<Ts, Tags::Event>)
+                    swapEventBuffers();
+                else if constexpr (Registry::template contains<Ts>())
                     clearComponentsByTag<Ts>();
                 else
-                    getStoredComponents().erase(getComponentHash<Ts>());
+                {
+                    // Observed sets are emptied first so the removed ids are reported
+                    auto cSetPtr = getComponentSetPtr<Ts>();
+                    if (cSetPtr && cSetPtr->getObservers())
+                        cSetPtr->clear();
+
+                    eraseComponentSet(getComponentHash<Ts>());
+                }
             }(),
             ...);
     }
 
-    template <typename Tag> void clearComponentsByTag()
+    /*
+     * @brief Swap the current and previous buffers of every event component set
+     *
+     * The previous buffer becomes the current one and is emptied without releasing its capacity, so the sets
+     * are not reallocated from frame to frame.  Only the current buffer is observed, so the observers follow
+     * it, and the events dropped from the previous buffer are not reported as removed.
+     */
+    void swapEventBuffers()
     {
-        auto tagHashes = getTagHashes<Tag>();
-        for (auto &tagHash : tagHashes)
+        for (auto &taggedSet : getTaggedSets<Tags::Event>())
         {
-            if (!tagHash || m_tagMap.find(tagHash) == m_tagMap.end())
+            auto currentIter = getStoredComponents().find(taggedSet.componentHash);
+            auto previousIter = m_previousEvents.find(taggedSet.componentHash);
+            if (currentIter == getStoredComponents().end() || previousIter == m_previousEvents.end())
                 continue;
 
-            for (auto &componentHash : m_tagMap[tagHash])
-                getStoredComponents().erase(componentHash);
+            std::swap(currentIter->second, previousIter->second);
 
-            m_tagMap.erase(tagHash);
+            auto &current = getSetFromIterator(currentIter);
+            auto &previous = getSetFromIterator(previousIter);
+            current.clear();
+            current.setObservers(previous.getObservers());
+            previous.setObservers(nullptr);
         }
     }
 
@@ -659,28 +1212,39 @@ template <typename EntityId> class EntityComponentManager
         (getComponentSet<Ts>(m_minSetSize).erase(eId), ...);
     }
 
-    template <typename Tag, typename Func> void eachComponentByTag(Func fn)
+    /*
+     * @brief Empty every component set with the tag while keeping the sets and their capacity
+     */
+    template <typename Tag> void clearComponentsByTag()
     {
-        auto tagHashes = getTagHashes<Tag>();
-        for (auto &tagHash : tagHashes)
+        for (auto &taggedSet : getTaggedSets<Tag>())
         {
-            if (!tagHash)
-                continue;
+            auto iter = getStoredComponents().find(taggedSet.componentHash);
+            if (iter != getStoredComponents().end())
+                getSetFromIterator(iter).clear();
+        }
+    }
 
-            auto tagIter = m_tagMap.find(tagHash);
-            if (tagIter == m_tagMap.end())
+    /*
+     * @brief Remove empty components from every component set with the tag, and destroy the emptied sets
+     */
+    template <typename Tag> void pruneComponentsByTag()
+    {
+        std::vector<size_t> emptiedHashes;
+        for (auto &taggedSet : getTaggedSets<Tag>())
+        {
+            auto iter = getStoredComponents().find(taggedSet.componentHash);
+            if (iter == getStoredComponents().end())
                 continue;
 
-            auto &hashSet = tagIter->second;
-            for (auto &componentHash : hashSet)
-            {
-                auto compIter = getStoredComponents().find(componentHash);
-                if (compIter == getStoredComponents().end())
-                    continue;
-
-                castErasedTo<Tag>(compIter).each(fn);
-            }
+            auto &cSet = getSetFromIterator(iter);
+            cSet.prune();
+            if (!cSet.size())
+                emptiedHashes.push_back(taggedSet.componentHash);
         }
+
+        for (auto &componentHash : emptiedHashes)
+            eraseComponentSet(componentHash);
     }
 
     template <typename T> size_t getComponentHash() const
@@ -688,24 +1252,12 @@ template <typename EntityId> class EntityComponentManager
         return typeid(T).hash_code();
     }
 
-    template <typename T> const std::array<size_t, 7> getTagHashes() const
-    {
-        return {
-            Utilities::isEvent<T>() ? typeid(Tags::Event).hash_code() : 0,
-            Utilities::isEffect<T>() ? typeid(Tags::Effect).hash_code() : 0,
-            Utilities::isNotStacked<T>() ? typeid(Tags::NoStack).hash_code() : 0,
-            Utilities::isStacked<T>() ? typeid(Tags::Stack).hash_code() : 0,
-            Utilities::isTransform<T>() ? typeid(Tags::Transform).hash_code() : 0,
-            Utilities::isRequired<T>() ? typeid(Tags::Required).hash_code() : 0,
-            Utilities::isUnique<T>() ? typeid(Tags::Unique).hash_code() : 0,
-        };
-    }
-
     template <typename T> ComponentSet<T> &castErasedTo(StoredComponents::iterator &iter)
     {
 #ifdef ecs_unsafe_casts
         return *static_cast<ComponentSet<T> *>(&getSetFromIterator(iter));
 #else
+        ECS_COUNT(dynamicCasts)
         auto casted = dynamic_cast<ComponentSet<T> *>(&getSetFromIterator(iter));
         ECS_ASSERT(casted, Utilities::getTypeName<T>() + " Failed dynamic_cast!")
 
@@ -747,14 +1299,44 @@ template <typename EntityId> class EntityComponentManager
     }
 
   private:
+#ifdef ecs_enable_memory_resource
+    static constexpr size_t DEFAULT_SCRATCH_SIZE = 64 * 1024;
+
+    std::pmr::memory_resource *m_resource{std::pmr::get_default_resource()};
+    std::vector<std::byte> m_scratchBuffer{};
+    std::optional<std::pmr::monotonic_buffer_resource> m_scratchResource{};
+    std::pmr::memory_resource *m_scratch{nullptr};
+    uint64_t m_scratchResets{0};
+#endif
     StoredComponents m_componentMap{};
+    StoredComponents m_previousEvents{};
     StoredTags m_tagMap{};
+    StoredObservers m_observerMap{};
+    StoredIndexes m_indexMap{};
     StoredTransformationFnMap m_transformationMap{};
+    StoredEmptyComponents m_emptyComponents{};
     EntityId m_nextEntityId{0};
+    Tick m_tick{1};
 
     size_t m_standardSetSize = 10024;
     size_t m_minSetSize = 100;
 
+#ifdef ecs_enable_counters
+  public:
+    /**
+     * @brief Get the hot-path counters recorded since the previous snapshot, and reset them
+     *
+     * Intended to be called once per frame.  The counters are shared by every manager used on the calling
+     * thread.
+     *
+     * @return Counters
+     */
+    [[nodiscard]] Counters snapshotCounters()
+    {
+        return std::exchange(getCounters(), Counters{});
+    }
+#endif
+
 #ifdef ecs_allow_experimental
   public:
     /*
@@ -763,58 +1345,26 @@ template <typename EntityId> class EntityComponentManager
      */
     void pruneAll()
     {
-        for (auto iter = getStoredComponents().begin(); iter != getStoredComponents().end();)
+        std::vector<size_t> emptiedHashes;
+        for (auto iter = getStoredComponents().begin(); iter != getStoredComponents().end(); ++iter)
         {
-            std::vector<EntityId> ids;
-
             auto &cSet = getSetFromIterator(iter);
             cSet.prune();
 
-            if (iter->first, !cSet.size())
-            {
-                iter = getStoredComponents().erase(iter);
-                continue;
-            }
-
-            ++iter;
+            if (!cSet.size())
+                emptiedHashes.push_back(iter->first);
         }
-    }
 
-    /*
-     * !!! CAUSES UNDEFINED BEHAVIOR - DO NOT USE !!!
-     * // TODO Task : See if casting can be updated to make this a
-     * // viable method without undefined behavior
-     */
-    template <typename Tag, typename Func> void eachByTag(Func fn)
-    {
-        eachComponentByTag<Tag>(fn);
+        for (auto &componentHash : emptiedHashes)
+            eraseComponentSet(componentHash);
     }
 
     /*
-     * !!! POTENTIALLY CAUSES UNDEFINED BEHAVIOR !!!
-     * @brief Iterate over component sets by tag to cleanup empty components
-     *
-     * Iterate over specific sets by tag to either remove stale entities, or
-     * delete the entire set if all entity components within are stale.
+     * @deprecated Use .prune<Tag>() instead
      */
     template <typename Tag> void pruneByTag()
     {
-        auto tagHashes = getTagHashes<Tag>();
-        for (auto &tagHash : tagHashes)
-        {
-            if (!tagHash)
-                continue;
-
-            auto tagIter = m_tagMap.find(tagHash);
-            if (tagIter == m_tagMap.end())
-                continue;
-
-            auto &hashSet = tagIter->second;
-            for (auto &componentHash : hashSet)
-            {
-                prune<Tag>(componentHash);
-            }
-        }
+        prune<Tag>();
     }
 
 #endif
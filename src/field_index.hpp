@@ -0,0 +1,133 @@
+#pragma once
+
+#include "component_index.hpp"
+#include "core.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Hash index from the values of a component field to the entities holding them
+ *
+ * Turns finding the entities whose field equals a value into an average constant time lookup instead of a
+ * scan over the whole component set.  Entities with several stacked components are found by each of their
+ * distinct values.  A lookup only re-indexes the entities changed since the previous one.
+ *
+ * @tparam EntityId - Entity id type
+ * @tparam T - Component type
+ * @tparam Field - Field type, which must be hashable and equality comparable
+ */
+template <typename EntityId, typename T, typename Field> class FieldIndex : public ComponentIndex<EntityId, T>
+{
+    static_assert(std::equality_comparable<Field>, "Indexed fields must be equality comparable!");
+
+  public:
+    explicit FieldIndex(Field T::*field) : m_field(field)
+    {
+    }
+
+    [[nodiscard]] bool isIndexing(Field T::*field) const
+    {
+        return m_field == field;
+    }
+
+    /**
+     * @brief Find the entities which have a component with the field value
+     *
+     * @param Value
+     *
+     * @return Container of entity ids, in no particular order.  Invalidated by the next change to the index
+     */
+    [[nodiscard]] const std::vector<EntityId> &find(const Field &value)
+    {
+        this->sync();
+
+        static const std::vector<EntityId> notFound{};
+        auto iter = m_buckets.find(value);
+
+        return iter != m_buckets.end() ? iter->second : notFound;
+    }
+
+    /**
+     * @brief Count the entities which have a component with the field value
+     *
+     * @param Value
+     *
+     * @return size_t
+     */
+    [[nodiscard]] size_t count(const Field &value)
+    {
+        return find(value).size();
+    }
+
+  private:
+    struct IndexedValue
+    {
+        Field value;
+        size_t slot;
+    };
+
+    void index(EntityId eId, ComponentsWrapper<T> &comps) override
+    {
+        unindex(eId);
+
+        auto &indexedValues = getIndexedValues(eId);
+        comps.inspect(
+            [&](const T &component) {
+                const auto &value = component.*m_field;
+                for (const auto &indexed : indexedValues)
+                    if (indexed.value == value)
+                        return;
+
+                auto &bucket = m_buckets[value];
+                indexedValues.push_back({value, bucket.size()});
+                bucket.push_back(eId);
+            },
+            Transformation::PRESERVE);
+    }
+
+    void unindex(EntityId eId) override
+    {
+        if (eId >= m_indexedValues.size())
+            return;
+
+        for (const auto &indexed : m_indexedValues[eId])
+        {
+            auto iter = m_buckets.find(indexed.value);
+            auto &bucket = iter->second;
+
+            if (indexed.slot != bucket.size() - 1)
+            {
+                auto movedId = bucket.back();
+                bucket[indexed.slot] = movedId;
+                for (auto &movedIndexed : m_indexedValues[movedId])
+                    if (movedIndexed.value == indexed.value)
+                        movedIndexed.slot = indexed.slot;
+            }
+            bucket.pop_back();
+
+            if (bucket.empty())
+                m_buckets.erase(iter);
+        }
+
+        m_indexedValues[eId].clear();
+    }
+
+    [[nodiscard]] std::vector<IndexedValue> &getIndexedValues(EntityId eId)
+    {
+        if (eId >= m_indexedValues.size())
+            m_indexedValues.resize(static_cast<size_t>(eId) + eId / 2 + 1);
+
+        return m_indexedValues[eId];
+    }
+
+    Field T::*m_field;
+
+    std::unordered_map<Field, std::vector<EntityId>> m_buckets{};
+    std::vector<std::vector<IndexedValue>> m_indexedValues{};
+};
+
+} // namespace internal
+} // namespace ECS
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "core.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Count, sum, min, max, and mean of an arithmetic component field
+ *
+ * Min, max, and mean have no value when no component was summarized
+ */
+template <typename Field> struct FieldSummary
+{
+    // Integral fields are summed in 64 bits, so summing a large set does not overflow
+    using Sum = std::conditional_t<std::is_floating_point_v<Field>, Field,
+                                   std::conditional_t<std::is_signed_v<Field>, int64_t, uint64_t>>;
+
+    size_t count{0};
+    Sum sum{0};
+    std::optional<Field> min{};
+    std::optional<Field> max{};
+
+    [[nodiscard]] std::optional<double> mean() const
+    {
+        if (!count)
+            return std::nullopt;
+
+        return static_cast<double>(sum) / static_cast<double>(count);
+    }
+};
+
+/**
+ * @brief Accumulates the values of a field in fixed-size blocks
+ *
+ * Every block is contiguous and reduced with independent lanes, so the compiler can vectorize it, and the
+ * block sums are combined pairwise as a tree.  The order of the operations only depends on the order of the
+ * values, so floating point results are deterministic, and the pairwise sums keep the rounding error low over
+ * millions of values.
+ */
+template <typename Field> class FieldReducer
+{
+  public:
+    using Sum = typename FieldSummary<Field>::Sum;
+
+    void add(Field value)
+    {
+        m_block[m_blockSize++] = value;
+        if (m_blockSize == BLOCK_SIZE)
+            flush();
+    }
+
+    [[nodiscard]] FieldSummary<Field> finish()
+    {
+        flush();
+
+        FieldSummary<Field> summary;
+        summary.count = m_count;
+        if (!m_count)
+            return summary;
+
+        summary.min = m_min;
+        summary.max = m_max;
+        for (size_t level = 0; level < LEVELS; ++level)
+        {
+            if (m_occupiedLevels & (uint64_t{1} << level))
+                summary.sum += m_levels[level];
+        }
+
+        return summary;
+    }
+
+  private:
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr size_t LANES = 8;
+    static constexpr size_t LEVELS = 64;
+
+    void flush()
+    {
+        if (!m_blockSize)
+            return;
+
+        std::array<Sum, LANES> lanes{};
+        size_t i = 0;
+        for (; i + LANES <= m_blockSize; i += LANES)
+        {
+            for (size_t lane = 0; lane < LANES; ++lane)
+                lanes[lane] += m_block[i + lane];
+        }
+        for (; i < m_blockSize; ++i)
+            lanes[i % LANES] += m_block[i];
+
+        for (size_t width = LANES / 2; width > 0; width /= 2)
+        {
+            for (size_t lane = 0; lane < width; ++lane)
+                lanes[lane] += lanes[lane + width];
+        }
+
+        auto [blockMin, blockMax] = std::minmax_element(m_block.begin(), m_block.begin() + m_blockSize);
+        m_min = m_count ? std::min(m_min, *blockMin) : *blockMin;
+        m_max = m_count ? std::max(m_max, *blockMax) : *blockMax;
+
+        m_count += m_blockSize;
+        m_blockSize = 0;
+        carry(lanes[0]);
+    }
+
+    /*
+     * Adds the block sum like a binary counter, so each level holds the sum of 2^level blocks
+     */
+    void carry(Sum sum)
+    {
+        size_t level = 0;
+        for (; m_occupiedLevels & (uint64_t{1} << level); ++level)
+        {
+            sum = m_levels[level] + sum;
+            m_occupiedLevels &= ~(uint64_t{1} << level);
+        }
+
+        m_levels[level] = sum;
+        m_occupiedLevels |= uint64_t{1} << level;
+    }
+
+    // Left uninitialized, only the filled part of the block and the occupied levels are read
+    std::array<Field, BLOCK_SIZE> m_block;
+    size_t m_blockSize{0};
+    size_t m_count{0};
+    Field m_min{};
+    Field m_max{};
+    std::array<Sum, LEVELS> m_levels;
+    uint64_t m_occupiedLevels{0};
+};
+
+} // namespace internal
+} // namespace ECS
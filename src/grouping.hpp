@@ -1,5 +1,6 @@
 #pragma once
 
+#include "components.hpp"
 #include "macros.hpp"
 #include "utilities.hpp"
 
@@ -8,6 +9,27 @@ namespace ECS
 namespace internal
 {
 
+/**
+ * @brief Query filter which narrows a grouping down to the entities whose component changed after a given tick
+ */
+template <typename T> struct Changed
+{
+};
+
+template <typename T> struct QueriedComponent
+{
+    using type = T;
+    static constexpr bool isChanged = false;
+};
+
+template <typename T> struct QueriedComponent<Changed<T>>
+{
+    using type = T;
+    static constexpr bool isChanged = true;
+};
+
+template <typename T> using QueriedComponentType = typename QueriedComponent<T>::type;
+
 /**
  * @brief A grouping of entities which have all of the specified components.
  */
@@ -19,7 +41,7 @@ template <typename EntityId, typename... Ts> class Grouping
 
   public:
     Grouping(std::vector<EntityId> _ids = {}) {};
-    Grouping(std::vector<EntityId> _ids, std::tuple<Ts *...> _values) : m_ids(_ids), m_values(_values) {};
+    Grouping(std::vector<EntityId> _ids, std::tuple<Ts *...> _values) : m_ids(std::move(_ids)), m_values(_values) {};
 
     /**
      * @brief Iterate over component set and pass the entity components into the function
@@ -31,6 +53,7 @@ template <typename EntityId, typename... Ts> class Grouping
      */
     template <typename Func> void each(Func &&fn)
     {
+        ECS_TRACE_SCOPE("Grouping::each")
         if constexpr (Utilities::ReturnsBool<Func, EntityId, Ts...>)
             eachWithBreak(fn);
         else
@@ -71,7 +94,87 @@ template <typename EntityId, typename... Ts> class Grouping
         return m_ids;
     }
 
+    /**
+     * @brief Get the k entities with the smallest keys, in ascending order of key
+     *
+     * Keeps the k best entities seen so far as a heap, so it runs in O(n log k), eg: the closest targets
+     * across the whole group.  Pass std::greater<>{} to get the largest keys instead
+     *
+     * @param Number of entities
+     * @param Key function which accepts the entity id and the components, and returns a comparable key
+     * @param Key comparison
+     *
+     * @return Entity ids
+     */
+    template <typename KeyFn, typename Compare = std::less<>>
+    [[nodiscard]] std::vector<EntityId> topBy(size_t k, KeyFn &&keyFn, Compare isBefore = {})
+    {
+        if (!k)
+            return {};
+
+        using Key = std::decay_t<
+            std::invoke_result_t<KeyFn &, EntityId, decltype(*std::declval<Ts &>().get(EntityId{}))...>>;
+        std::vector<std::pair<Key, EntityId>> heap;
+        heap.reserve(std::min(k, m_ids.size()));
+        auto isHeapBefore = [&](const auto &a, const auto &b) { return isBefore(a.first, b.first); };
+        eachNoBreak([&](EntityId id, auto &...comps) {
+            Key key = keyFn(id, comps...);
+            if (heap.size() == k)
+            {
+                // The front of the heap is the worst of the k best
+                if (!isBefore(key, heap.front().first))
+                    return;
+
+                std::pop_heap(heap.begin(), heap.end(), isHeapBefore);
+                heap.pop_back();
+            }
+
+            heap.emplace_back(std::move(key), id);
+            std::push_heap(heap.begin(), heap.end(), isHeapBefore);
+        });
+        std::sort_heap(heap.begin(), heap.end(), isHeapBefore);
+
+        std::vector<EntityId> ids;
+        ids.reserve(heap.size());
+        for (const auto &[_, id] : heap)
+            ids.push_back(id);
+
+        return ids;
+    }
+
+    /**
+     * @brief Get the count, sum, min, max, and mean of an arithmetic component property across the grouping
+     *
+     * @param Component::Prop, of one of the grouped components
+     * @param Transformation pipeline behavior
+     *
+     * @return Summary of the property
+     */
+    template <typename Comp, typename Field>
+    [[nodiscard]] FieldSummary<Field> summarize(Field Comp::*field,
+                                                Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        static_assert((std::is_same_v<Wrapper<Ts>, ComponentsWrapper<Comp>> || ...),
+                      "Component is not part of the grouping.");
+
+        FieldReducer<Field> reducer;
+        eachNoBreak([&](EntityId id, auto &...comps) {
+            (
+                [&](auto &wrapper) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(wrapper)>, ComponentsWrapper<Comp>>)
+                        wrapper.inspect([&](const Comp &comp) { reducer.add(comp.*field); }, behavior);
+                }(comps),
+                ...);
+        });
+
+        return reducer.finish();
+    }
+
   private:
+    template <typename Set>
+    using Wrapper = std::remove_reference_t<decltype(*std::declval<Set &>().get(EntityId{}))>;
+
     template <typename Func> void eachWithBreak(Func &&fn)
     {
         for (const auto &id : m_ids)
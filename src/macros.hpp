@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core.hpp"
+#include "counters.hpp"
+#include "tracing.hpp"
 #include "utilities.hpp"
 
 #ifdef ecs_disable_asserts
@@ -14,3 +16,15 @@
 #else
 #define ECS_LOG_WARNING(...) ;
 #endif
+
+#ifdef ecs_enable_counters
+#define ECS_COUNT(counter) ++ECS::internal::getCounters().counter;
+#else
+#define ECS_COUNT(...) ;
+#endif
+
+#ifdef ecs_enable_tracing
+#define ECS_TRACE_SCOPE(name) ECS::internal::TraceScope ecsTraceScope{name, "ecs"};
+#else
+#define ECS_TRACE_SCOPE(...) ;
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Memory held by the component set of a single component type
+ *
+ * Byte counts cover the allocated capacity rather than the used size, since that is what the process holds.
+ */
+struct ComponentMemoryStats
+{
+    // Mangled component type name, as given by Utilities::getTypeName()
+    const char *typeName{};
+
+    // Entities in the set, including the ones whose wrapper holds no component
+    size_t liveCount{};
+    // Components stored across every wrapper of the set
+    size_t componentCount{};
+    // Wrappers holding no component, eg: inserted by .get() for a missing entity or emptied by .remove()
+    size_t emptyWrappers{};
+    // Wrappers which have a transformation function attached
+    size_t transformers{};
+
+    size_t denseCapacity{};
+    size_t sparseSlots{};
+
+    // Dense values and ids, over their capacity
+    size_t denseBytes{};
+    // Sparse array mapping entity ids to dense indexes
+    size_t sparseBytes{};
+    // Wrapper bytes which are not an inline component, for the live entities
+    size_t wrapperOverheadBytes{};
+    // Heap allocations owned by the wrappers, eg: stacked components.  The state captured by transformation
+    // functions is not included, since std::function does not tell whether it is stored on the heap
+    size_t heapBytes{};
+
+    [[nodiscard]] size_t totalBytes() const
+    {
+        return denseBytes + sparseBytes + heapBytes;
+    }
+
+    ComponentMemoryStats &operator+=(const ComponentMemoryStats &other)
+    {
+        liveCount += other.liveCount;
+        componentCount += other.componentCount;
+        emptyWrappers += other.emptyWrappers;
+        transformers += other.transformers;
+        denseCapacity += other.denseCapacity;
+        sparseSlots += other.sparseSlots;
+        denseBytes += other.denseBytes;
+        sparseBytes += other.sparseBytes;
+        wrapperOverheadBytes += other.wrapperOverheadBytes;
+        heapBytes += other.heapBytes;
+
+        return *this;
+    }
+};
+
+/**
+ * @brief Memory held by every component set of a manager
+ *
+ * Can be kept around and filled again, so sampling reuses the capacity of the previous sample.
+ */
+struct MemoryStats
+{
+    std::vector<ComponentMemoryStats> components{};
+
+    [[nodiscard]] size_t totalBytes() const
+    {
+        size_t total{};
+        for (const auto &componentStats : components)
+            total += componentStats.totalBytes();
+
+        return total;
+    }
+};
+
+} // namespace internal
+} // namespace ECS
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "core.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Batches the entity ids which had a component added, removed, or overwritten
+ *
+ * Ids are only recorded for a change type once an observer has been registered for it.  The recorded ids are
+ * delivered to every observer as a single list when the observers are flushed, typically once per frame.
+ */
+template <typename Id> class Observers
+{
+  public:
+    using ObserverFn = std::function<void(const std::vector<Id> &)>;
+
+    void onAdd(ObserverFn fn)
+    {
+        m_added.callbacks.push_back(std::move(fn));
+    }
+
+    void onRemove(ObserverFn fn)
+    {
+        m_removed.callbacks.push_back(std::move(fn));
+    }
+
+    void onOverwrite(ObserverFn fn)
+    {
+        m_overwritten.callbacks.push_back(std::move(fn));
+    }
+
+    /**
+     * @brief Append every removed id to the log as soon as it is removed, independently of flushing
+     *
+     * Used by indexes, which drain the log themselves whenever they synchronise
+     *
+     * @param Log - Must outlive the observers
+     */
+    void addRemovedLog(std::vector<Id> *removedLog)
+    {
+        m_removedLogs.push_back(removedLog);
+    }
+
+    /**
+     * @brief Append the id of every added, overwritten, or mutated component to the log as it is stamped
+     *
+     * Used by indexes, so they only re-index the entities which changed since they last synchronised
+     *
+     * @param Log - Must outlive the observers
+     */
+    void addChangedLog(std::vector<Id> *changedLog)
+    {
+        m_changedLogs.push_back(changedLog);
+    }
+
+    void added(Id id)
+    {
+        m_added.record(id);
+    }
+
+    void removed(Id id)
+    {
+        m_removed.record(id);
+
+        for (auto removedLog : m_removedLogs)
+            removedLog->push_back(id);
+    }
+
+    void overwritten(Id id)
+    {
+        m_overwritten.record(id);
+    }
+
+    void changed(Id id)
+    {
+        for (auto changedLog : m_changedLogs)
+            changedLog->push_back(id);
+    }
+
+    /**
+     * @brief Deliver the batched ids to the observers and reset the batches
+     */
+    void flush()
+    {
+        m_added.flush();
+        m_removed.flush();
+        m_overwritten.flush();
+    }
+
+  private:
+    struct Channel
+    {
+        std::vector<Id> ids;
+        std::vector<Id> dispatching;
+        std::vector<ObserverFn> callbacks;
+
+        void record(Id id)
+        {
+            if (!callbacks.empty())
+                ids.push_back(id);
+        }
+
+        void flush()
+        {
+            if (ids.empty())
+                return;
+
+            // Ids recorded by the callbacks themselves are kept for the next flush
+            dispatching.swap(ids);
+            for (auto &callback : callbacks)
+                callback(dispatching);
+
+            dispatching.clear();
+        }
+    };
+
+    Channel m_added;
+    Channel m_removed;
+    Channel m_overwritten;
+    std::vector<std::vector<Id> *> m_removedLogs;
+    std::vector<std::vector<Id> *> m_changedLogs;
+};
+
+} // namespace internal
+} // namespace ECS
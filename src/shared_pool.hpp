@@ -0,0 +1,170 @@
+#pragma once
+
+#include "core.hpp"
+#include "macros.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Interns the values of Shared-tagged components so identical values are only stored once
+ *
+ * Values are bucketed by std::hash when the component provides a specialization, otherwise every value lands
+ * in the same bucket and is compared linearly.  The pool only keeps weak references, and a value removes its
+ * own entry when the last entity referring to it lets go, so released values do not pile up in the buckets.
+ *
+ * Every component set of a Shared-tagged component owns its pool, so values are only interned within a single
+ * manager, and the pool needs no more synchronization than the set.  The interned values keep their pool
+ * alive, so a value which outlives its set can still be released.
+ */
+template <typename T> class SharedPool : public std::enable_shared_from_this<SharedPool<T>>
+{
+  public:
+    static_assert(std::equality_comparable<T>, "Shared components must be equality comparable.");
+
+    SharedPool() = default;
+
+    /**
+     * @brief Get the interned instance which is equal to the value, interning the value if there is none
+     *
+     * @param Value
+     *
+     * @return Handle to the interned value
+     */
+    [[nodiscard]] std::shared_ptr<const T> intern(T value)
+    {
+        auto hash = getHash(value);
+        auto &bucket = m_buckets[hash];
+        for (const auto &entry : bucket)
+        {
+            if (*entry.value != value)
+                continue;
+
+            if (auto interned = entry.handle.lock())
+                return interned;
+        }
+
+        // Not from make_shared, so the value is freed with its entry rather than with the last weak reference
+        std::shared_ptr<const T> interned(new const T(std::move(value)),
+                                          [pool = this->shared_from_this(), hash](const T *released) {
+                                              pool->release(hash, released);
+                                          });
+        bucket.push_back({interned.get(), interned});
+
+        return interned;
+    }
+
+    /**
+     * @brief Get the number of unique values which are still referenced
+     *
+     * @return size_t
+     */
+    [[nodiscard]] size_t size() const
+    {
+        size_t count{};
+        for (const auto &[_, bucket] : m_buckets)
+            count += bucket.size();
+
+        return count;
+    }
+
+    SharedPool(const SharedPool &) = delete;
+    SharedPool &operator=(const SharedPool &) = delete;
+
+  private:
+    struct Entry
+    {
+        const T *value;
+        std::weak_ptr<const T> handle;
+    };
+
+    void release(size_t hash, const T *released)
+    {
+        auto iter = m_buckets.find(hash);
+        if (iter != m_buckets.end())
+        {
+            std::erase_if(iter->second, [&](const Entry &entry) { return entry.value == released; });
+            if (iter->second.empty())
+                m_buckets.erase(iter);
+        }
+
+        delete released;
+    }
+
+    [[nodiscard]] size_t getHash(const T &value) const
+    {
+        if constexpr (requires { std::hash<T>{}(value); })
+            return std::hash<T>{}(value);
+        else
+            return 0;
+    }
+
+    std::unordered_map<size_t, std::vector<Entry>> m_buckets{};
+};
+
+/**
+ * @brief Stores a handle to an interned Shared-tagged component in place of the component itself
+ *
+ * Provides the parts of the std::optional interface which the components wrapper relies on.  Values are
+ * interned in the pool of the component set holding the wrapper, and are only kept on their own while the
+ * wrapper belongs to no set.  Mutations copy the interned value and re-intern the result, so other entities
+ * never observe them.
+ */
+template <typename T> class SharedHandle
+{
+  public:
+    [[nodiscard]] bool has_value() const
+    {
+        return !!m_value;
+    }
+
+    template <typename... Args> void emplace(SharedPool<T> *pool, Args... args)
+    {
+        assign(pool, T(args...));
+    }
+
+    void reset()
+    {
+        m_value.reset();
+    }
+
+    /*
+     * The components wrapper only hands out const access to shared components, and refuses to .unpack() them
+     */
+    [[nodiscard]] T *operator->() const
+    {
+        return const_cast<T *>(m_value.get());
+    }
+
+    template <typename Func> void mutate(SharedPool<T> *pool, Func &&fn)
+    {
+        T copy = *m_value;
+        fn(copy);
+        assign(pool, std::move(copy));
+    }
+
+    /*
+     * Move the value into the pool of the set which the wrapper was placed in
+     */
+    void intern(SharedPool<T> *pool)
+    {
+        if (m_value && pool)
+            m_value = pool->intern(*m_value);
+    }
+
+  private:
+    void assign(SharedPool<T> *pool, T value)
+    {
+        if (pool)
+            m_value = pool->intern(std::move(value));
+        else
+            m_value = std::make_shared<const T>(std::move(value));
+    }
+
+    std::shared_ptr<const T> m_value{};
+};
+
+} // namespace internal
+} // namespace ECS
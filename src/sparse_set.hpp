@@ -3,6 +3,7 @@
 #include "base_sparse_set.hpp"
 #include "components.hpp"
 #include "macros.hpp"
+#include "observers.hpp"
 #include "utilities.hpp"
 
 namespace ECS
@@ -11,27 +12,44 @@ namespace internal
 {
 /**
  * @brief A sparse set for storing components of the same type.
+ *
+ * When compiled with ecs_enable_memory_resource, every allocation of the set, including the allocations made
+ * by its values, comes from the memory resource given on construction.
  */
 template <typename Id, typename T>
 class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
 {
   public:
-    template <typename EntityId> friend class EntityComponentManager;
+    template <typename EntityId, typename... CustomTags> friend class EntityComponentManager;
     template <typename EntityId, typename... Ts> friend class Grouping;
+    template <typename EntityId, typename Component> friend class ComponentIndex;
 
     explicit SparseSet(size_t _initialSize, size_t _resize) : m_resize(_resize)
     {
-        m_pointers.resize(_initialSize, -1);
-        m_values.reserve(_initialSize);
-        m_ids.reserve(_initialSize);
+        reserve(_initialSize);
+        attachClock();
     }
 
+#ifdef ecs_enable_memory_resource
+    /**
+     * @param Initial size
+     * @param Resize - Initial size of the sparse array, when it had none
+     * @param Memory resource - Must outlive the set
+     */
+    SparseSet(size_t _initialSize, size_t _resize, std::pmr::memory_resource *resource)
+        : m_resize(_resize), m_pointers(resource), m_values(resource), m_ids(resource)
+    {
+        reserve(_initialSize);
+        attachClock();
+    }
+#endif
+
     explicit operator bool() const
     {
         return size() > 0;
     }
 
-    [[nodiscard]] const std::vector<Id> &getIds()
+    [[nodiscard]] const StorageVector<Id> &getIds()
     {
 
 #ifndef ecs_disable_auto_prune
@@ -60,10 +78,221 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
             eachNoBreak(func);
     }
 
+    /**
+     * @brief Each loop over the values which changed after the specified tick
+     *
+     * The function argument can optionally return a bool to determine the loop-breaking behavior.
+     * A false return value is a break.
+     *
+     * The loop will skip empty values.
+     *
+     * @param Tick - Values changed at or before this tick are skipped
+     * @param Function
+     */
+    template <typename Func> void eachChanged(Tick sinceTick, Func &&func)
+    {
+        static_assert(std::is_invocable_v<Func, Id, T &>, "Each function must take T& as argument.");
+
+        for (auto i = 0; i < m_ids.size(); ++i)
+        {
+            if (!m_values[i] || m_values[i].getChangeTick() <= sinceTick)
+                continue;
+
+            if constexpr (Utilities::ReturnsBool<Func, Id, T &>)
+            {
+                if (!func(m_ids[i], m_values[i]))
+                    break;
+            }
+            else
+                func(m_ids[i], m_values[i]);
+        }
+    }
+
+    /**
+     * @brief Get the count, sum, min, max, and mean of an arithmetic component property across the set
+     *
+     * @param Component::Prop
+     * @param Transformation pipeline behavior
+     *
+     * @return Summary of the property
+     */
+    template <typename Comp, typename Field>
+    [[nodiscard]] FieldSummary<Field> summarize(Field Comp::*field,
+                                                Transformation behavior = Transformation::DEFAULT)
+        requires std::is_arithmetic_v<Field>
+    {
+        FieldReducer<Field> reducer;
+        for (auto &value : m_values)
+            value.inspect([&](const Comp &comp) { reducer.add(comp.*field); }, behavior);
+
+        return reducer.finish();
+    }
+
+    /**
+     * @brief Reorder the values in place by ascending key
+     *
+     * Uses an insertion sort, which is close to linear when the order barely changed since the previous sort,
+     * eg: sorting by depth every frame.  Falls back to a full sort when the values are far from sorted.
+     * Equal keys keep their relative order.  Empty values, eg: inserted by .get() for a missing entity, are
+     * not passed to the key function and are moved after the others.
+     *
+     * @param Key function which accepts the id and the value, and returns a comparable key
+     */
+    template <typename KeyFn> void sortBy(KeyFn &&keyFn)
+    {
+        static_assert(std::is_invocable_v<KeyFn, Id, T &>, "Key function must take Id and T& as arguments.");
+
+        using Key = std::decay_t<std::invoke_result_t<KeyFn, Id, T &>>;
+        std::vector<std::pair<Key, size_t>> keyed;
+        std::vector<size_t> emptyIndexes;
+        keyed.reserve(m_ids.size());
+        for (size_t i = 0; i < m_ids.size(); ++i)
+        {
+            if (m_values[i])
+                keyed.emplace_back(keyFn(m_ids[i], m_values[i]), i);
+            else
+                emptyIndexes.push_back(i);
+        }
+
+        auto isLess = [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; };
+        if (!insertionSort(keyed, isLess))
+            std::stable_sort(keyed.begin(), keyed.end(), isLess);
+
+        std::vector<size_t> order;
+        order.reserve(m_ids.size());
+        for (const auto &[_, index] : keyed)
+            order.push_back(index);
+        order.insert(order.end(), emptyIndexes.begin(), emptyIndexes.end());
+
+        permute(order);
+    }
+
+    /**
+     * @brief Reorder the values so the ids shared with another set come first, in the order of the other set
+     *
+     * Ids which are not in the other set, or whose value is empty, follow in no particular order.  Sharing an
+     * order keeps the iteration of a group over both sets sequential.
+     *
+     * @param Other component set
+     */
+    template <typename OtherSet> void sortAs(OtherSet &other)
+    {
+        size_t position{};
+        for (const auto &id : other.getIds())
+        {
+            if (!contains(id) || !m_values[m_pointers[id]])
+                continue;
+
+            auto index = m_pointers[id];
+            if (index != position)
+                swapDense(index, position);
+
+            ++position;
+        }
+    }
+
+    /**
+     * @brief Measure the memory held by the set and its values
+     *
+     * The counts and bytes which live inside the wrappers need a walk over the values.  Skipping it keeps the
+     * cost constant, for sampling every frame.
+     *
+     * @param Whether or not to walk the values
+     *
+     * @return Memory stats
+     */
+    [[nodiscard]] ComponentMemoryStats memoryStats(bool shouldWalkValues = true) const override
+    {
+        ComponentMemoryStats stats;
+        stats.typeName = T::getComponentTypeName();
+        stats.liveCount = m_ids.size();
+        stats.emptyWrappers = m_clock.emptyValues;
+        stats.denseCapacity = m_values.capacity();
+        stats.sparseSlots = m_pointers.size();
+        stats.denseBytes = m_values.capacity() * sizeof(T) + m_ids.capacity() * sizeof(Id);
+        stats.sparseBytes = m_pointers.capacity() * sizeof(size_t);
+
+        if (shouldWalkValues)
+            for (const auto &value : m_values)
+                value.collectMemoryStats(stats);
+
+        return stats;
+    }
+
+    /**
+     * @brief Get the number of unique values which the set interns, for Shared-tagged components
+     *
+     * @return size_t
+     */
+    [[nodiscard]] size_t getSharedCount() const
+    {
+        if constexpr (std::is_void_v<typename T::SharedValues>)
+            return 0;
+        else
+            return m_sharedPool->size();
+    }
+
     SparseSet(const SparseSet &) = delete;
     SparseSet &operator=(const SparseSet &) = delete;
 
+#ifdef ecs_allow_unsafe
+    /*
+     * Allows direct access to the dense values of the set, in the same order as .unpackIds().
+     * Be aware that this bypasses all safeguards, and the span is invalidated by any insertion or removal.
+     */
+    [[nodiscard]] std::span<T> unpackValues()
+    {
+        return m_values;
+    }
+
+    /*
+     * Allows direct access to the dense ids of the set, in the same order as .unpackValues()
+     */
+    [[nodiscard]] std::span<const Id> unpackIds() const
+    {
+        return m_ids;
+    }
+#endif
+
   private:
+    void reserve(size_t initialSize)
+    {
+        m_pointers.resize(initialSize, -1);
+        m_values.reserve(initialSize);
+        m_ids.reserve(initialSize);
+    }
+
+    void attachClock()
+    {
+        m_clock.set = this;
+        m_clock.stampEntity = &stampEntity;
+
+        if constexpr (!std::is_void_v<typename T::SharedValues>)
+        {
+            m_sharedPool = std::make_shared<typename T::SharedValues>();
+            m_clock.sharedPool = m_sharedPool.get();
+        }
+    }
+
+    /*
+     * @brief Record a change on the value of an entity, for the wrappers derived from it
+     */
+    static void stampEntity(void *set, uint64_t entityId)
+    {
+        auto &self = *static_cast<SparseSet *>(set);
+        auto id = static_cast<Id>(entityId);
+        if (self.contains(id))
+            self.m_values[self.m_pointers[id]].markChanged();
+    }
+
+    /*
+     * @brief Report a change on the value of an entity to the observers of the set
+     */
+    static void logChange(void *set, uint64_t entityId)
+    {
+        static_cast<SparseSet *>(set)->m_observers->changed(static_cast<Id>(entityId));
+    }
+
     template <typename Func> void eachNoBreak(Func &&func)
     {
         for (auto i = 0; i < m_ids.size();)
@@ -76,6 +305,7 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
 #ifndef ecs_disable_auto_prune
                 if (!m_values[i])
                 {
+                    ECS_COUNT(prunedElements)
                     erase(m_ids[i]);
                     continue;
                 }
@@ -97,6 +327,7 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
 #ifndef ecs_disable_auto_prune
                 if (!m_values[i])
                 {
+                    ECS_COUNT(prunedElements)
                     erase(m_ids[i]);
                     continue;
                 }
@@ -114,6 +345,74 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
                 func(m_ids[i], m_values[i]);
     }
 
+    /*
+     * Gives up once the values have been shifted more than a few times their count, since the input is then
+     * too far from sorted for an insertion sort to pay off
+     */
+    template <typename Keyed, typename Compare> static bool insertionSort(Keyed &keyed, Compare &&isLess)
+    {
+        size_t shiftBudget = keyed.size() * 8;
+        for (size_t i = 1; i < keyed.size(); ++i)
+        {
+            if (!isLess(keyed[i], keyed[i - 1]))
+                continue;
+
+            auto current = std::move(keyed[i]);
+            auto j = i;
+            for (; j > 0 && isLess(current, keyed[j - 1]); --j)
+            {
+                keyed[j] = std::move(keyed[j - 1]);
+                if (!shiftBudget--)
+                {
+                    keyed[j - 1] = std::move(current);
+                    return false;
+                }
+            }
+
+            keyed[j] = std::move(current);
+        }
+
+        return true;
+    }
+
+    /*
+     * Moves the value at order[i] to index i, following the permutation cycles so each value is moved once
+     */
+    void permute(std::vector<size_t> &order)
+    {
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            if (order[i] == i)
+                continue;
+
+            auto current = i;
+            auto value = std::move(m_values[i]);
+            auto id = m_ids[i];
+            while (order[current] != i)
+            {
+                auto next = order[current];
+                m_values[current] = std::move(m_values[next]);
+                m_ids[current] = m_ids[next];
+                m_pointers[m_ids[current]] = current;
+                order[current] = current;
+                current = next;
+            }
+
+            m_values[current] = std::move(value);
+            m_ids[current] = id;
+            m_pointers[id] = current;
+            order[current] = current;
+        }
+    }
+
+    void swapDense(size_t lhs, size_t rhs)
+    {
+        std::swap(m_values[lhs], m_values[rhs]);
+        std::swap(m_ids[lhs], m_ids[rhs]);
+        m_pointers[m_ids[lhs]] = lhs;
+        m_pointers[m_ids[rhs]] = rhs;
+    }
+
     [[nodiscard]] T *get(Id id)
     {
         return contains(id) ? &(m_values[m_pointers[id]]) : nullptr;
@@ -160,6 +459,7 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
             auto pSize = m_pointers.size();
             auto newSize = pSize > 0 ? pSize + (pSize / 2) : m_resize;
             m_pointers.resize(newSize, -1);
+            ECS_COUNT(sparseResizes)
             m_values.reserve(newSize);
             m_ids.reserve(newSize);
         }
@@ -167,6 +467,7 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
         m_pointers[id] = m_ids.size();
         // TODO Performance : See if using a pair to store id with component is better
         m_ids.push_back(id);
+        m_clock.emptyValues += !value;
         m_values.push_back(std::move(value));
     }
 
@@ -188,13 +489,17 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
             auto pSize = m_pointers.size();
             auto newSize = pSize > 0 ? pSize + (pSize / 2) : m_resize;
             m_pointers.resize(newSize, -1);
+            ECS_COUNT(sparseResizes)
             m_values.reserve(newSize);
             m_ids.reserve(newSize);
         }
 
         m_pointers[id] = m_ids.size();
         m_ids.push_back(id);
-        return &m_values.emplace_back(args...);
+        auto &value = m_values.emplace_back(args...);
+        m_clock.emptyValues += !value;
+
+        return &value;
     }
 
     void overwrite(Id id, T value)
@@ -205,7 +510,10 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
             return;
         }
 
-        m_values[m_pointers[id]] = std::move(value);
+        auto &stored = m_values[m_pointers[id]];
+        m_clock.emptyValues += !value;
+        m_clock.emptyValues -= !stored;
+        stored = std::move(value);
     }
 
     void erase(Id id1) override
@@ -217,6 +525,9 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
         auto lastIndex = m_ids.size() - 1;
 
         auto lastId = m_ids[lastIndex];
+        // Dummy values inserted on a lookup miss never held a component, so their removal is not reported
+        bool isReported = m_observers && m_values[valIndex].hasHeldComponents();
+        m_clock.emptyValues -= !m_values[valIndex];
 
         std::swap(m_values[valIndex], m_values[lastIndex]);
         m_values.pop_back();
@@ -226,6 +537,30 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
 
         m_pointers[lastId] = valIndex;
         m_pointers[id1] = -1;
+
+        if (isReported)
+            m_observers->removed(id1);
+    }
+
+    /**
+     * @brief Remove every element while keeping the allocated capacity for reuse
+     *
+     * Only the sparse slots which are in use are reset, so the cost is linear in the number of elements
+     * rather than in the size of the sparse array.
+     */
+    void clear() override
+    {
+        for (size_t i = 0; i < m_ids.size(); ++i)
+        {
+            m_pointers[m_ids[i]] = -1;
+
+            if (m_observers && m_values[i].hasHeldComponents())
+                m_observers->removed(m_ids[i]);
+        }
+
+        m_values.clear();
+        m_ids.clear();
+        m_clock.emptyValues = 0;
     }
 
     template <typename... Ids> void erase(Id id, Ids... ids)
@@ -247,12 +582,14 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
 
     void prune() override
     {
+        ECS_COUNT(prunePasses)
         for (auto i = 0; i < m_ids.size();)
         {
             if (m_pointers[m_ids[i]] != -1)
             {
                 if (!m_values[i])
                 {
+                    ECS_COUNT(prunedElements)
                     erase(m_ids[i]);
                     continue;
                 }
@@ -262,14 +599,51 @@ class SparseSet : public BaseSparseSet<Id, ComponentsWrapper<DefaultComponent>>
         }
     }
 
+    [[nodiscard]] Observers<Id> *getObservers() const override
+    {
+        return m_observers;
+    }
+
+    void setObservers(Observers<Id> *observers) override
+    {
+        m_observers = observers;
+        m_clock.logChange = observers ? &logChange : nullptr;
+    }
+
+    /**
+     * @brief Get the clock which stamps the changes made to the values of this set
+     */
+    [[nodiscard]] ChangeClock &getClock()
+    {
+        return m_clock;
+    }
+
+    /**
+     * @brief Get the empty value returned for lookups which must not insert into the set
+     *
+     * It is reset on every call, so whatever was done through a previous miss does not leak into the next
+     * one.
+     */
+    [[nodiscard]] T &getMissing()
+    {
+        if (!m_missing.isPristine())
+            m_missing = T{T::ComponentFlags::EMPTY};
+
+        return m_missing;
+    }
+
   private:
     using value_type = T;
     size_t m_resize{};
     bool m_isLocked{false};
-
-    std::vector<size_t> m_pointers{};
-    std::vector<T> m_values{};
-    std::vector<Id> m_ids{};
+    Observers<Id> *m_observers{nullptr};
+    ChangeClock m_clock{};
+    std::shared_ptr<typename T::SharedValues> m_sharedPool{};
+    T m_missing{T::ComponentFlags::EMPTY};
+
+    StorageVector<size_t> m_pointers{};
+    StorageVector<T> m_values{};
+    StorageVector<Id> m_ids{};
 
 #ifdef ecs_allow_debug
   public:
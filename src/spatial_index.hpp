@@ -0,0 +1,289 @@
+#pragma once
+
+#include "component_index.hpp"
+#include "core.hpp"
+#include "macros.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Uniform grid over two coordinates of a NoStack-tagged component, used for range and neighbor queries
+ *
+ * Each entity is bucketed into the grid cell which contains its coordinates.  A query only visits the cells
+ * which overlap the queried area, so its cost depends on the number of nearby entities rather than on the size
+ * of the component set.  Entities which moved are re-bucketed on the next query.
+ *
+ * @tparam EntityId - Entity id type
+ * @tparam T - Component type
+ * @tparam Coord - Coordinate type, eg: float or int
+ */
+template <typename EntityId, typename T, typename Coord> class SpatialIndex : public ComponentIndex<EntityId, T>
+{
+    static_assert(!Utilities::shouldStack<T>(), "Spatial indexes require a NoStack-tagged component!");
+    static_assert(std::is_arithmetic_v<Coord>, "Spatial index coordinates must be arithmetic!");
+
+  public:
+    /**
+     * @param T::x - Member holding the x coordinate
+     * @param T::y - Member holding the y coordinate
+     * @param Cell size - Width and height of a grid cell, ideally close to the typical query radius
+     */
+    SpatialIndex(Coord T::*x, Coord T::*y, Coord cellSize) : m_x(x), m_y(y), m_cellSize(cellSize)
+    {
+        ECS_ASSERT(cellSize > 0, "Spatial index cell size must be positive!")
+    }
+
+    [[nodiscard]] bool isIndexing(Coord T::*x, Coord T::*y) const
+    {
+        return m_x == x && m_y == y;
+    }
+
+    /**
+     * @brief Find the entities within the radius of a point, borders included
+     *
+     * @param x
+     * @param y
+     * @param Radius
+     * @param Output container, which is cleared first so it can be reused between queries
+     */
+    void queryRadius(Coord x, Coord y, Coord radius, std::vector<EntityId> &found)
+    {
+        found.clear();
+
+        // Computed as double, since the box of unsigned or integer coordinates could wrap around
+        double cx = x;
+        double cy = y;
+        double r = radius;
+        auto radiusSquared = r * r;
+
+        eachInArea(cx - r, cy - r, cx + r, cy + r, [&](const Entry &entry) {
+            auto dx = static_cast<double>(entry.x) - cx;
+            auto dy = static_cast<double>(entry.y) - cy;
+            if (dx * dx + dy * dy <= radiusSquared)
+                found.push_back(entry.id);
+        });
+    }
+
+    /**
+     * @brief Find the entities within the radius of a point, borders included
+     *
+     * @param x
+     * @param y
+     * @param Radius
+     *
+     * @return Container of entity ids
+     */
+    [[nodiscard]] std::vector<EntityId> queryRadius(Coord x, Coord y, Coord radius)
+    {
+        std::vector<EntityId> found;
+        queryRadius(x, y, radius, found);
+
+        return found;
+    }
+
+    /**
+     * @brief Find the entities within an axis-aligned box, borders included
+     *
+     * @param Minimum x
+     * @param Minimum y
+     * @param Maximum x
+     * @param Maximum y
+     * @param Output container, which is cleared first so it can be reused between queries
+     */
+    void queryAABB(Coord minX, Coord minY, Coord maxX, Coord maxY, std::vector<EntityId> &found)
+    {
+        found.clear();
+        eachInArea(minX, minY, maxX, maxY, [&](const Entry &entry) {
+            if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY)
+                found.push_back(entry.id);
+        });
+    }
+
+    /**
+     * @brief Find the entities within an axis-aligned box, borders included
+     *
+     * @param Minimum x
+     * @param Minimum y
+     * @param Maximum x
+     * @param Maximum y
+     *
+     * @return Container of entity ids
+     */
+    [[nodiscard]] std::vector<EntityId> queryAABB(Coord minX, Coord minY, Coord maxX, Coord maxY)
+    {
+        std::vector<EntityId> found;
+        queryAABB(minX, minY, maxX, maxY, found);
+
+        return found;
+    }
+
+  private:
+    using CellKey = uint64_t;
+
+    struct Entry
+    {
+        EntityId id;
+        Coord x;
+        Coord y;
+    };
+
+    struct Location
+    {
+        CellKey cell{};
+        size_t slot{};
+        bool isIndexed{false};
+    };
+
+    /*
+     * Only visits the cells of the area which lie within the bounds of the occupied cells.  When there are
+     * still more of them than occupied cells, the occupied cells are visited instead, so a query never costs
+     * more than a pass over the occupied cells
+     */
+    template <typename Func> void eachInArea(double minX, double minY, double maxX, double maxY, Func &&fn)
+    {
+        this->sync();
+
+        int64_t minCellX = std::max(getCellCoord(minX), m_minCellX);
+        int64_t maxCellX = std::min(getCellCoord(maxX), m_maxCellX);
+        int64_t minCellY = std::max(getCellCoord(minY), m_minCellY);
+        int64_t maxCellY = std::min(getCellCoord(maxY), m_maxCellY);
+        if (minCellX > maxCellX || minCellY > maxCellY)
+            return;
+
+        auto areaCells = static_cast<double>(maxCellX - minCellX + 1) * (maxCellY - minCellY + 1);
+        if (areaCells > m_cells.size())
+        {
+            for (const auto &[cell, entries] : m_cells)
+            {
+                auto cellX = static_cast<int32_t>(cell >> 32);
+                auto cellY = static_cast<int32_t>(cell & UINT32_MAX);
+                if (cellX < minCellX || cellX > maxCellX || cellY < minCellY || cellY > maxCellY)
+                    continue;
+
+                for (const auto &entry : entries)
+                    fn(entry);
+            }
+
+            return;
+        }
+
+        for (auto cellX = minCellX; cellX <= maxCellX; ++cellX)
+        {
+            for (auto cellY = minCellY; cellY <= maxCellY; ++cellY)
+            {
+                auto cell = getCellKey(static_cast<int32_t>(cellX), static_cast<int32_t>(cellY));
+                auto iter = m_cells.find(cell);
+                if (iter == m_cells.end())
+                    continue;
+
+                for (const auto &entry : iter->second)
+                    fn(entry);
+            }
+        }
+    }
+
+    void index(EntityId eId, ComponentsWrapper<T> &comps) override
+    {
+        auto [x, y] = comps.peek(Transformation::PRESERVE, m_x, m_y);
+        auto cellX = getCellCoord(x);
+        auto cellY = getCellCoord(y);
+        auto cell = getCellKey(cellX, cellY);
+
+        auto &location = getLocation(eId);
+        if (location.isIndexed && location.cell == cell)
+        {
+            auto &entry = m_cells[cell][location.slot];
+            entry.x = x;
+            entry.y = y;
+            return;
+        }
+
+        if (location.isIndexed)
+            eraseEntry(location);
+
+        auto &entries = m_cells[cell];
+        location = {cell, entries.size(), true};
+        entries.push_back({eId, x, y});
+
+        m_minCellX = std::min(m_minCellX, cellX);
+        m_maxCellX = std::max(m_maxCellX, cellX);
+        m_minCellY = std::min(m_minCellY, cellY);
+        m_maxCellY = std::max(m_maxCellY, cellY);
+    }
+
+    void unindex(EntityId eId) override
+    {
+        if (eId >= m_locations.size() || !m_locations[eId].isIndexed)
+            return;
+
+        eraseEntry(m_locations[eId]);
+        m_locations[eId].isIndexed = false;
+    }
+
+    void eraseEntry(const Location &location)
+    {
+        auto iter = m_cells.find(location.cell);
+        auto &entries = iter->second;
+
+        if (location.slot != entries.size() - 1)
+        {
+            entries[location.slot] = entries.back();
+            m_locations[entries[location.slot].id].slot = location.slot;
+        }
+        entries.pop_back();
+
+        if (entries.empty())
+            m_cells.erase(iter);
+
+        // The bounds only grow while cells are occupied, they are reset once none is
+        if (m_cells.empty())
+            resetCellBounds();
+    }
+
+    void resetCellBounds()
+    {
+        m_minCellX = m_minCellY = INT32_MAX;
+        m_maxCellX = m_maxCellY = INT32_MIN;
+    }
+
+    [[nodiscard]] Location &getLocation(EntityId eId)
+    {
+        if (eId >= m_locations.size())
+            m_locations.resize(static_cast<size_t>(eId) + eId / 2 + 1);
+
+        return m_locations[eId];
+    }
+
+    /*
+     * Coordinates beyond the range of the cells are clamped into the outermost cells
+     */
+    [[nodiscard]] int32_t getCellCoord(double value) const
+    {
+        auto cell = std::floor(value / static_cast<double>(m_cellSize));
+
+        return static_cast<int32_t>(std::clamp<double>(cell, INT32_MIN, INT32_MAX));
+    }
+
+    [[nodiscard]] static CellKey getCellKey(int32_t cellX, int32_t cellY)
+    {
+        return (static_cast<CellKey>(static_cast<uint32_t>(cellX)) << 32) | static_cast<uint32_t>(cellY);
+    }
+
+    Coord T::*m_x;
+    Coord T::*m_y;
+    Coord m_cellSize;
+
+    std::unordered_map<CellKey, std::vector<Entry>> m_cells{};
+    std::vector<Location> m_locations{};
+    // Bounds of the cells which were occupied since the index last emptied
+    int32_t m_minCellX{INT32_MAX};
+    int32_t m_maxCellX{INT32_MIN};
+    int32_t m_minCellY{INT32_MAX};
+    int32_t m_maxCellY{INT32_MIN};
+};
+
+} // namespace internal
+} // namespace ECS
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core.hpp"
+
+#ifdef ecs_enable_memory_resource
+#include <memory_resource>
+#endif
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Vector type of the storage owned by component sets and components wrappers
+ *
+ * When compiled with ecs_enable_memory_resource, the storage allocates from the memory resource given to the
+ * manager.  Otherwise it is a plain std::vector, which keeps every wrapper three pointers smaller.
+ */
+#ifdef ecs_enable_memory_resource
+template <typename T> using StorageVector = std::pmr::vector<T>;
+#else
+template <typename T> using StorageVector = std::vector<T>;
+#endif
+
+} // namespace internal
+} // namespace ECS
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core.hpp"
+#include "tags.hpp"
+
+namespace ECS
+{
+namespace internal
+{
+
+/**
+ * @brief Compile-time list of the tags which the manager indexes component sets by
+ *
+ * Every registered tag gets its own flat list of the component sets whose component derives from it, so batch
+ * operations on a tag never need to search for the matching sets.
+ */
+template <typename... Tags> struct TagRegistry
+{
+    /**
+     * @brief Check whether or not the tag is registered
+     */
+    template <typename Tag> [[nodiscard]] static constexpr bool contains()
+    {
+        return (std::is_same_v<Tag, Tags> || ...);
+    }
+
+    /**
+     * @brief Call the templated function once for every registered tag
+     */
+    template <typename Func> static constexpr void each(Func &&fn)
+    {
+        (fn.template operator()<Tags>(), ...);
+    }
+
+    /**
+     * @brief Apply the registered tags to a container template, eg: a tuple of per-tag lists
+     */
+    template <template <typename> typename Container> using Apply = std::tuple<Container<Tags>...>;
+};
+
+using BuiltInTags = TagRegistry<Tags::Stack, Tags::Event, Tags::NoStack, Tags::Transform, Tags::Required,
+                                Tags::Unique, Tags::Shared, Tags::Effect>;
+
+template <typename... CustomTags>
+using RegisteredTags = TagRegistry<Tags::Stack, Tags::Event, Tags::NoStack, Tags::Transform, Tags::Required,
+                                   Tags::Unique, Tags::Shared, Tags::Effect, CustomTags...>;
+
+} // namespace internal
+} // namespace ECS
@@ -51,6 +51,17 @@ struct Unique
 {
 };
 
+/**
+ * @brief Interns identical component values so they are only stored once, with each entity holding a handle
+ * to the shared value.  Mutations copy the value on write, so they never affect other entities.  Shared
+ * components are never stacked and must be equality comparable
+ */
+struct Shared
+{
+    // Allows tagged components to default their own comparison operator
+    bool operator==(const Shared &) const = default;
+};
+
 /**
  * @deprecated This will be removed in a future version once custom tags are implemented
  *
@@ -116,9 +127,14 @@ template <typename T> constexpr bool isUnique()
     return isBase<T, Tags::Unique>();
 }
 
+template <typename T> constexpr bool isShared()
+{
+    return isBase<T, Tags::Shared>();
+}
+
 template <typename T> constexpr bool shouldStack()
 {
-    if (isNotStacked<T>())
+    if (isNotStacked<T>() || isShared<T>())
         return false;
 
     if (isEvent<T>())
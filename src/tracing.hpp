@@ -0,0 +1,289 @@
+#pragma once
+
+#include "core.hpp"
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+
+namespace ECS
+{
+namespace internal
+{
+
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+/**
+ * @brief Fixed-size ring buffer of the trace events recorded by a single thread
+ *
+ * Only the owning thread writes to the buffer, so recording is a plain store followed by a release of the
+ * write count.  Once full, the oldest events are overwritten.
+ */
+class TraceBuffer
+{
+  public:
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    explicit TraceBuffer(uint32_t threadId) : m_threadId(threadId), m_events(CAPACITY)
+    {
+    }
+
+    void record(const TraceEvent &event)
+    {
+        auto written = m_written.load(std::memory_order_relaxed);
+        m_events[written & (CAPACITY - 1)] = event;
+        m_written.store(written + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Call the function on every event which is still in the buffer, from oldest to newest
+     *
+     * Meant to be called once recording has stopped, events recorded meanwhile may be torn.
+     */
+    template <typename Func> void each(Func &&fn) const
+    {
+        auto written = m_written.load(std::memory_order_acquire);
+        auto first = written > CAPACITY ? written - CAPACITY : 0;
+        for (auto i = first; i < written; ++i)
+            fn(m_events[i & (CAPACITY - 1)]);
+    }
+
+    void clear()
+    {
+        m_written.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @brief Hand the buffer over to another thread, dropping the events of the previous one
+     *
+     * @param Id of the new owning thread
+     */
+    void reset(uint32_t threadId)
+    {
+        m_threadId = threadId;
+        clear();
+    }
+
+    [[nodiscard]] uint32_t getThreadId() const
+    {
+        return m_threadId;
+    }
+
+  private:
+    uint32_t m_threadId;
+    std::vector<TraceEvent> m_events;
+    std::atomic<uint64_t> m_written{0};
+};
+
+/**
+ * @brief Owns the per-thread trace buffers and writes them as Chrome trace-event JSON
+ *
+ * The JSON opens in chrome://tracing and in Perfetto.  A lock is only taken when a thread records its first
+ * event or exits, and when the buffers are written or cleared.
+ *
+ * The buffer of an exited thread is pooled, and keeps its events until a new thread takes it over.  So only
+ * as many buffers are allocated as there were threads recording at once.
+ */
+class Tracer
+{
+  public:
+    [[nodiscard]] static Tracer &instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    [[nodiscard]] TraceBuffer &getThreadBuffer()
+    {
+        thread_local ThreadBuffer buffer{*this};
+        return buffer.get();
+    }
+
+    [[nodiscard]] uint64_t now() const
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    /**
+     * @brief Write the recorded events as Chrome trace-event JSON
+     *
+     * @param Output stream
+     */
+    void writeJson(std::ostream &out)
+    {
+        std::lock_guard lock(m_mutex);
+
+        // Fixed to the nanosecond, since the default precision drops it once a trace runs past a second
+        auto flags = out.flags();
+        auto precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+
+        out << "{\"traceEvents\":[";
+        bool isFirst = true;
+        for (const auto &buffer : m_buffers)
+        {
+            buffer->each([&](const TraceEvent &event) {
+                // Chrome expects microseconds
+                out << (isFirst ? "" : ",") << "\n{\"name\":";
+                writeJsonString(out, event.name);
+                out << ",\"cat\":";
+                writeJsonString(out, event.category);
+                out << ",\"ph\":\"X\",\"ts\":" << event.startNs / 1000.0
+                    << ",\"dur\":" << event.durationNs / 1000.0 << ",\"pid\":1,\"tid\":"
+                    << buffer->getThreadId() << "}";
+                isFirst = false;
+            });
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    /**
+     * @brief Drop every recorded event
+     */
+    void clear()
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto &buffer : m_buffers)
+            buffer->clear();
+    }
+
+    /**
+     * @brief Get the number of buffers allocated, pooled ones included
+     */
+    [[nodiscard]] size_t getBufferCount()
+    {
+        std::lock_guard lock(m_mutex);
+        return m_buffers.size();
+    }
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+  private:
+    /*
+     * Holds the buffer of the current thread, and returns it to the pool when the thread exits
+     */
+    class ThreadBuffer
+    {
+      public:
+        explicit ThreadBuffer(Tracer &tracer) : m_tracer(tracer), m_buffer(tracer.acquireBuffer())
+        {
+        }
+
+        ~ThreadBuffer()
+        {
+            m_tracer.releaseBuffer(m_buffer);
+        }
+
+        ThreadBuffer(const ThreadBuffer &) = delete;
+        ThreadBuffer &operator=(const ThreadBuffer &) = delete;
+
+        [[nodiscard]] TraceBuffer &get()
+        {
+            return m_buffer;
+        }
+
+      private:
+        Tracer &m_tracer;
+        TraceBuffer &m_buffer;
+    };
+
+    Tracer() = default;
+
+    TraceBuffer &acquireBuffer()
+    {
+        std::lock_guard lock(m_mutex);
+        auto threadId = ++m_threadCount;
+        if (m_pooledBuffers.empty())
+            return *m_buffers.emplace_back(std::make_unique<TraceBuffer>(threadId));
+
+        auto *buffer = m_pooledBuffers.back();
+        m_pooledBuffers.pop_back();
+        buffer->reset(threadId);
+
+        return *buffer;
+    }
+
+    void releaseBuffer(TraceBuffer &buffer)
+    {
+        std::lock_guard lock(m_mutex);
+        m_pooledBuffers.push_back(&buffer);
+    }
+
+    static void writeJsonString(std::ostream &out, const char *str)
+    {
+        out << '"';
+        for (; *str; ++str)
+        {
+            auto c = static_cast<unsigned char>(*str);
+            if (c == '"' || c == '\\')
+                out << '\\' << *str;
+            else if (c < 0x20)
+                out << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 0xf];
+            else
+                out << *str;
+        }
+        out << '"';
+    }
+
+    std::chrono::steady_clock::time_point m_start{std::chrono::steady_clock::now()};
+    std::mutex m_mutex{};
+    std::vector<std::unique_ptr<TraceBuffer>> m_buffers{};
+    // Buffers of the exited threads, ready to be taken over
+    std::vector<TraceBuffer *> m_pooledBuffers{};
+    uint32_t m_threadCount{0};
+};
+
+/**
+ * @brief Records the lifetime of the scope as a trace event, when compiled with ecs_enable_tracing
+ *
+ * Compiles to nothing otherwise, so it can be left around user-defined systems.
+ */
+class TraceScope
+{
+  public:
+    /**
+     * The buffer of the thread is acquired before the start is read, so allocating it on the first scope of a
+     * thread is not counted in that scope
+     *
+     * @param Name - Must outlive the trace, eg: a string literal
+     * @param Category - Must outlive the trace, eg: a string literal
+     */
+    explicit TraceScope([[maybe_unused]] const char *name, [[maybe_unused]] const char *category = "system")
+#ifdef ecs_enable_tracing
+        : m_buffer(Tracer::instance().getThreadBuffer()), m_name(name), m_category(category),
+          m_start(Tracer::instance().now())
+#endif
+    {
+    }
+
+    ~TraceScope()
+    {
+#ifdef ecs_enable_tracing
+        m_buffer.record({m_name, m_category, m_start, Tracer::instance().now() - m_start});
+#endif
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+#ifdef ecs_enable_tracing
+  private:
+    TraceBuffer &m_buffer;
+    const char *m_name;
+    const char *m_category;
+    uint64_t m_start;
+#endif
+};
+
+} // namespace internal
+} // namespace ECS
@@ -16,5 +16,6 @@ using Stack = ECS::Tags::Stack;
 using NoStack = ECS::Tags::NoStack;
 using Event = ECS::Tags::Event;
 using Transform = ECS::Tags::Transform;
+using Shared = ECS::Tags::Shared;
 
 #define PRINT(...) ECS::internal::Utilities::print(__VA_ARGS__);
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Replaces the global operator new and delete to count the heap allocations of the current thread.
+ *
+ * Replacement allocation functions may not be inline, so this header must be included by exactly one
+ * translation unit of an executable, eg: the runner of the tests or of the benchmarks.
+ */
+namespace Allocations
+{
+
+struct Counts
+{
+    uint64_t allocations{};
+    uint64_t bytes{};
+    uint64_t deallocations{};
+};
+
+[[nodiscard]] inline Counts &getThreadCounts()
+{
+    thread_local Counts counts{};
+    return counts;
+}
+
+/**
+ * @brief Counts the allocations made by the current thread during its lifetime
+ */
+class Scope
+{
+  public:
+    Scope() : m_start(getThreadCounts())
+    {
+    }
+
+    [[nodiscard]] uint64_t getAllocations() const
+    {
+        return getThreadCounts().allocations - m_start.allocations;
+    }
+
+    [[nodiscard]] uint64_t getBytes() const
+    {
+        return getThreadCounts().bytes - m_start.bytes;
+    }
+
+    // Allocations made during the scope which were not freed yet, net of the earlier ones freed meanwhile
+    [[nodiscard]] int64_t getLiveAllocations() const
+    {
+        auto &counts = getThreadCounts();
+        return static_cast<int64_t>(counts.allocations - m_start.allocations) -
+               static_cast<int64_t>(counts.deallocations - m_start.deallocations);
+    }
+
+  private:
+    Counts m_start;
+};
+
+inline void *allocate(std::size_t size, std::align_val_t alignment = std::align_val_t{0})
+{
+    auto &counts = getThreadCounts();
+    ++counts.allocations;
+    counts.bytes += size;
+
+    if (size == 0)
+        size = 1;
+
+    void *ptr{};
+    if (static_cast<std::size_t>(alignment) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        auto align = static_cast<std::size_t>(alignment);
+        ptr = std::aligned_alloc(align, (size + align - 1) / align * align);
+    }
+    else
+    {
+        ptr = std::malloc(size);
+    }
+
+    return ptr;
+}
+
+inline void deallocate(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    ++getThreadCounts().deallocations;
+    std::free(ptr);
+}
+
+} // namespace Allocations
+
+void *operator new(std::size_t size)
+{
+    if (auto *ptr = Allocations::allocate(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    if (auto *ptr = Allocations::allocate(size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (auto *ptr = Allocations::allocate(size, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (auto *ptr = Allocations::allocate(size, alignment))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Allocations::allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Allocations::allocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    Allocations::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    Allocations::deallocate(ptr);
+}
@@ -44,6 +44,16 @@ struct TestStackedComp : Stack
     }
 };
 
+// Stacked component without a default constructor
+struct TestBuffComp : Stack
+{
+    int val;
+
+    explicit TestBuffComp(int v) : val(v)
+    {
+    }
+};
+
 struct TestNonStackedComp : public NoStack
 {
     int val{};
@@ -67,6 +77,55 @@ struct TestEventComp : public Event
     std::string message{"this is an event component"};
 };
 
+struct TestUniqueComp : public ECS::Tags::Unique
+{
+    int val{};
+
+    TestUniqueComp()
+    {
+    }
+    TestUniqueComp(int v) : val(v)
+    {
+    }
+};
+
+struct TestSharedComp : public Shared
+{
+    int meshId{};
+    std::string material{"this is a shared component"};
+
+    TestSharedComp()
+    {
+    }
+    TestSharedComp(int id) : meshId(id)
+    {
+    }
+
+    bool operator==(const TestSharedComp &other) const = default;
+};
+
+// Spreads the interned values over buckets, as a real shared component would
+template <> struct std::hash<TestSharedComp>
+{
+    size_t operator()(const TestSharedComp &comp) const
+    {
+        return std::hash<int>{}(comp.meshId);
+    }
+};
+
+struct TestBurningTag
+{
+    int ticksLeft{3};
+};
+
+struct TestBurningStackedComp : public TestBurningTag, Stack
+{
+};
+
+struct TestBurningNonStackedComp : public TestBurningTag, NoStack
+{
+};
+
 struct TestVelocityComponent
 {
     float x{1.0f};
@@ -78,3 +137,30 @@ struct TestPositionComponent
     float x{0.0f};
     float y{0.0f};
 };
+
+// Grid cell with unsigned coordinates
+struct TestCellComp : public NoStack
+{
+    uint32_t col{};
+    uint32_t row{};
+
+    TestCellComp()
+    {
+    }
+    TestCellComp(uint32_t column, uint32_t cellRow) : col(column), row(cellRow)
+    {
+    }
+};
+
+struct TestGridPositionComp : public NoStack
+{
+    float x{};
+    float y{};
+
+    TestGridPositionComp()
+    {
+    }
+    TestGridPositionComp(float posX, float posY) : x(posX), y(posY)
+    {
+    }
+};
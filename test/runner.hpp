@@ -1,7 +1,16 @@
 #pragma once
 
 #include "core.hpp"
-#include "tests/benchmarks.hpp"
+#include "helpers/allocations.hpp"
+
+// Asserts that the statements make no heap allocations on the current thread
+#define EXPECT_NO_ALLOC(...)                                                                                 \
+    {                                                                                                        \
+        Allocations::Scope allocationScope;                                                                  \
+        __VA_ARGS__;                                                                                         \
+        assert(allocationScope.getAllocations() == 0 && "Unexpected allocation in: " #__VA_ARGS__);          \
+    }
+
 #include "tests/components.hpp"
 #include "tests/utilities.hpp"
 
@@ -12,12 +21,12 @@ enum class Tests {
     NONE = 0,
     COMPONENT_MANAGER,
     UTILITIES,
-    BENCHMARKS,
 };
 
 using testFn = std::function<void(CM &)>;
 inline std::vector<testFn> componentManagerTests{
     test_component_mutate_fn,
+    test_unpack_span,
     test_component_remove_fn,
     test_component_remove_conditionally,
 
@@ -28,6 +37,7 @@ inline std::vector<testFn> componentManagerTests{
 #endif
     
     test_get_component,
+    test_try_get_component,
     test_gather_component,
     test_gather_group,
     
@@ -36,6 +46,8 @@ inline std::vector<testFn> componentManagerTests{
     test_add_stacked_components,
     test_add_event_components,
     test_add_effect_components,
+    test_get_unique_component,
+    test_shared_components_are_interned,
 
     test_remove_single_entities_for_multiple_components,
     test_remove_multiple_entities_for_multiple_components,
@@ -43,7 +55,31 @@ inline std::vector<testFn> componentManagerTests{
     
     test_clear_all_components,
     test_clear_components_by_tag,
+    test_clear_event_components_swaps_buffers,
+    test_event_buffers_keep_capacity,
+    test_custom_tag_batch_operations,
     test_clear_all_by_entity,
+    test_observe_component_changes,
+    test_changed_components_since_tick,
+    test_spatial_index_queries,
+    test_field_index_find_by_value,
+    test_sort_component_sets,
+    test_memory_stats,
+    test_iteration_does_not_allocate,
+    test_iteration_covers_every_arrangement,
+    test_lazy_view_of_components,
+    test_top_k_and_selection,
+    test_field_reductions,
+#ifdef ecs_enable_memory_resource
+    test_sets_allocate_from_memory_resource,
+    test_derived_wrappers_allocate_from_scratch,
+#endif
+#ifdef ecs_enable_counters
+    test_hot_path_counters,
+#endif
+#ifdef ecs_enable_tracing
+    test_trace_events_written_as_json,
+#endif
     
     test_prune,
     test_prune_multi,
@@ -66,24 +102,6 @@ inline std::vector<testFn> utiltiesTests{
     test_get_enum_array,
 };
 
-inline std::vector<testFn> benchmarkTests{
-    test_benchmark_2M_create,
-    test_benchmark_2M_get_single_entity_single_type,
-    test_benchmark_2M_get_multiple_entities_single_type,
-    test_benchmark_2M_get_all,
-    test_benchmark_2M_gather,
-    test_benchmark_2M_gather_all,
-    test_benchmark_2M_gather_group,
-    test_benchmark_2M_access,
-    test_benchmark_2M_update,
-    test_benchmark_2M_destroy,
-    test_benchmark_2M_clear,
-    test_benchmark_2M_remove,
-#ifndef ecs_disable_auto_prune
-    test_benchmark_2M_remove_and_auto_prune,
-#endif
-};
-
 inline bool runTests(Tests testType) {
 
 
@@ -96,9 +114,6 @@ inline bool runTests(Tests testType) {
         case Tests::UTILITIES:
             tests = utiltiesTests;
             break;
-        case Tests::BENCHMARKS:
-            tests = benchmarkTests;
-            break;
         default:
             break;
     }
@@ -122,7 +137,6 @@ inline bool runTests(Tests testType) {
 };
 
 inline void run() { 
-#ifndef ecs_bench_test
     PRINT()
     PRINT("=================== RUNNING COMPONENT MANAGER TESTS ====================")
     PRINT()
@@ -135,12 +149,6 @@ inline void run() {
     PRINT("====================== RUNNING UTILITY TESTS ==========================")
     PRINT()
     runTests(Tests::UTILITIES); 
-
-#else
-    PRINT("====================== RUNNING BENCHMARK TESTS ==========================")
-    PRINT()
-    runTests(Tests::BENCHMARKS); 
-#endif
 };
 // clang-format on
 } // namespace TestSystem
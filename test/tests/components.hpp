@@ -4,6 +4,7 @@
 #include "../helpers/components.hpp"
 #include "../helpers/utils.hpp"
 #include <iostream>
+#include <thread>
 
 inline void test_get_component(CM &cm)
 {
@@ -32,6 +33,26 @@ inline void test_gather_component(CM &cm)
     assert(stackedComps.size() == 2);
 }
 
+inline void test_try_get_component(CM &cm)
+{
+    PRINT("TESTING MANAGER TRY GET METHOD")
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    cm.add<TestNonStackedComp>(id1, 5);
+
+    auto [hit, missingSet] = cm.tryGet<TestNonStackedComp, TestStackedComp>(id1);
+    assert(hit.peek(&TestNonStackedComp::val) == 5);
+    assert(!missingSet);
+    assert(!cm.exists<TestStackedComp>());
+
+    auto [miss] = cm.tryGet<TestNonStackedComp>(id2);
+    assert(!miss);
+
+    auto [nonStackedSet] = cm.getAll<TestNonStackedComp>();
+    assert(nonStackedSet.size() == 1);
+}
+
 inline void test_gather_group(CM &cm)
 {
     PRINT("TESTING MANAGER GATHER GROUP METHOD")
@@ -82,6 +103,49 @@ inline void test_component_mutate_fn(CM &cm)
     assert((*ptrVec[0]).val == 100);
 }
 
+inline void test_unpack_span(CM &cm)
+{
+    PRINT("TESTING UNPACK SPAN")
+
+    for (int i = 1; i <= 3; ++i)
+        cm.add<TestStackedComp>(1, i);
+    cm.add<TestNonStackedComp>(1, 7);
+    cm.add<TestNonStackedComp>(2, 8);
+
+    auto [stackedComps, nonStackedComps] = cm.get<TestStackedComp, TestNonStackedComp>(1);
+    std::span<TestStackedComp> stackedSpan;
+    EXPECT_NO_ALLOC(stackedSpan = stackedComps.unpackSpan();)
+    assert(stackedSpan.size() == 3 && stackedSpan[2].val == 3);
+
+    stackedSpan[0].val = 10;
+    assert(stackedComps.sum(&TestStackedComp::val) == 15);
+
+    auto nonStackedSpan = nonStackedComps.unpackSpan();
+    assert(nonStackedSpan.size() == 1 && nonStackedSpan[0].val == 7);
+
+    // Derived wrappers only point at the components
+    auto filteredComps = stackedComps.filter([](const TestStackedComp &comp) { return comp.val > 1; });
+    assert(filteredComps.unpackSpan().empty());
+
+    auto [nonStackedSet] = cm.getAll<TestNonStackedComp>();
+    auto values = nonStackedSet.unpackValues();
+    auto ids = nonStackedSet.unpackIds();
+    assert(values.size() == 2 && ids.size() == 2);
+    for (size_t i = 0; i < ids.size(); ++i)
+        assert(values[i].peek(&TestNonStackedComp::val) == static_cast<int>(ids[i]) + 6);
+
+    // Writes to transformed copies or interned values would be lost or leak into other entities
+    cm.registerTransformation<TestNonStackedComp>([](EntityId eId, TestNonStackedComp comp) { return comp; });
+    cm.add<TestNonStackedComp>(3, 9);
+    auto [transformerComps] = cm.get<TestNonStackedComp>(3);
+    transformerComps.inspect([](const TestNonStackedComp &comp) {}, ECS::internal::Transformation::TRANSFORM);
+    assert(transformerComps.unpackSpan().empty());
+    cm.add<TestSharedComp>(1);
+    auto [sharedComps] = cm.get<TestSharedComp>(1);
+    assert(sharedComps.unpackSpan().empty());
+    assert(sharedComps.unpack().empty());
+}
+
 inline void test_component_inspect_fn(CM &cm)
 {
     PRINT("TESTING COMPONENT INSPECT METHOD")
@@ -141,8 +205,7 @@ inline void test_effect_cleanup_timed(CM &cm)
     EntityId id = 2;
     cm.add<TestEffectCompTimed>(id, 0.0f);
 
-    cm.eachByTag<ECS::Tags::Effect>(
-        [&](EntityId eId, auto &effectComps) { effectComps.remove(isEffectExpired); });
+    cm.removeIf<ECS::Tags::Effect>(isEffectExpired);
 
     auto [testEffectTimed] = cm.get<TestEffectCompTimed>(id);
     assert(testEffectTimed.size() == 0);
@@ -156,8 +219,7 @@ inline void test_effect_cleanup(CM &cm)
     cm.add<TestEffectComp>(id);
     auto [testEffect] = cm.get<TestEffectComp>(id);
     testEffect.mutate(markForCleanup);
-    cm.eachByTag<ECS::Tags::Effect>(
-        [&](EntityId eId, auto &effectComps) { effectComps.remove(isEffectExpired); });
+    cm.removeIf<ECS::Tags::Effect>(isEffectExpired);
 
     testEffect.mutate([&](TestEffectComp &testEffect) { testEffect.value = 2; });
 
@@ -173,8 +235,7 @@ inline void test_effect_cleanup_only_effect_components(CM &cm)
     cm.add<TestTransformComp>(id);
     cm.add<TestNonStackedComp>(id);
 
-    cm.eachByTag<ECS::Tags::Effect>(
-        [&](EntityId eId, auto &effectComps) { effectComps.remove(isEffectExpired); });
+    cm.removeIf<ECS::Tags::Effect>(isEffectExpired);
 
     auto [testEvents] = cm.get<TestEventComp>(id);
     auto [testnonstacks] = cm.get<TestNonStackedComp>(id);
@@ -274,6 +335,96 @@ inline void test_add_effect_components(CM &cm)
     assert(comp.size() == 2);
 }
 
+inline void test_get_unique_component(CM &cm)
+{
+    PRINT("TESTING GET UNIQUE COMPONENT")
+
+    EntityId id1 = 3;
+    EntityId id2 = 4;
+
+    auto [missingId, missingComps] = cm.getUnique<TestUniqueComp>();
+    assert(missingId == 0);
+    assert(!missingComps);
+    assert(!cm.exists<TestUniqueComp>());
+
+    cm.add<TestUniqueComp>(id1, 7);
+    cm.add<TestUniqueComp>(id2, 8);
+
+    auto [ownerId, ownerComps] = cm.getUnique<TestUniqueComp>();
+    assert(ownerId == id1);
+    assert(ownerComps.peek(&TestUniqueComp::val) == 7);
+
+    // Looking up a non-owner must not pad the single slot with a dummy component
+    auto [otherComps] = cm.get<TestUniqueComp>(id2);
+    assert(!otherComps);
+    auto [uniqueSet] = cm.getAll<TestUniqueComp>();
+    assert(uniqueSet.size() == 1);
+
+    // Misses are owned by the manager, so another manager never sees the same empty wrapper
+    CM otherCm{};
+    auto [otherMissingId, otherMissingComps] = otherCm.getUnique<TestUniqueComp>();
+    assert(&otherMissingComps != &otherComps);
+    assert(!otherMissingComps);
+
+    cm.remove<TestUniqueComp>(id1);
+    cm.add<TestUniqueComp>(id2, 9);
+
+    auto [newOwnerId, newOwnerComps] = cm.getUnique<TestUniqueComp>();
+    assert(newOwnerId == id2);
+    assert(newOwnerComps.peek(&TestUniqueComp::val) == 9);
+}
+
+inline void test_shared_components_are_interned(CM &cm)
+{
+    PRINT("TESTING SHARED COMPONENTS ARE INTERNED")
+
+    for (EntityId id = 1; id <= 100; ++id)
+        cm.add<TestSharedComp>(id, 3);
+
+    auto [sharedSet] = cm.getAll<TestSharedComp>();
+    assert(sharedSet.getSharedCount() == 1);
+
+    // Other managers intern into their own pool
+    CM otherCm{};
+    otherCm.add<TestSharedComp>(1, 3);
+    auto [otherSet] = otherCm.getAll<TestSharedComp>();
+    auto [otherComps] = otherCm.get<TestSharedComp>(1);
+    assert(otherSet.getSharedCount() == 1);
+
+    auto [firstComps, secondComps] = cm.get<TestSharedComp>(1, 2);
+    assert(&firstComps.peek(&TestSharedComp::meshId) == &secondComps.peek(&TestSharedComp::meshId));
+    assert(&firstComps.peek(&TestSharedComp::meshId) != &otherComps.peek(&TestSharedComp::meshId));
+
+    firstComps.mutate([&](TestSharedComp &shared) { shared.meshId = 4; });
+
+    assert(sharedSet.getSharedCount() == 2);
+    assert(firstComps.peek(&TestSharedComp::meshId) == 4);
+    assert(secondComps.peek(&TestSharedComp::meshId) == 3);
+
+    // Mutating through a derived wrapper must not leak into the interned value
+    auto filtered = secondComps.filter([&](const TestSharedComp &_) { return true; });
+    filtered.mutate([&](TestSharedComp &shared) { shared.meshId = 5; });
+    assert(secondComps.peek(&TestSharedComp::meshId) == 3);
+
+    // Released values are freed along with their entry, rather than piling up until their hash comes back
+    {
+        Allocations::Scope allocationScope;
+        for (int meshId = 10; meshId < 1010; ++meshId)
+            firstComps.mutate([&](TestSharedComp &shared) { shared.meshId = meshId; });
+
+        assert(sharedSet.getSharedCount() == 2);
+        assert(allocationScope.getLiveAllocations() <= 2);
+    }
+
+    cm.overwrite<TestSharedComp>(1, 3);
+    assert(sharedSet.getSharedCount() == 1);
+
+    // A value outliving its set keeps the pool alive until it is released
+    auto keptComps = firstComps;
+    cm.clear<TestSharedComp>();
+    assert(keptComps.peek(&TestSharedComp::meshId) == 3);
+}
+
 inline void test_remove_single_entities_for_multiple_components(CM &cm)
 {
     PRINT("TESTING REMOVE SINGLE ID FROM MULTIPLE COMPONENT SETS")
@@ -393,6 +544,118 @@ inline void test_clear_components_by_tag(CM &cm)
     assert(!cm.exists<TestEventComp>());
 }
 
+inline void test_clear_event_components_swaps_buffers(CM &cm)
+{
+    PRINT("TESTING CLEAR EVENT COMPONENTS SWAPS BUFFERS")
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    cm.add<TestEventComp>(id1);
+
+    auto [currentSet] = cm.getAll<TestEventComp>();
+    auto *frontBuffer = &currentSet;
+    assert(currentSet.size() == 1);
+    assert(cm.getPreviousEvents<TestEventComp>().size() == 0);
+
+    cm.clear<ECS::Tags::Event>();
+
+    auto &previousSet = cm.getPreviousEvents<TestEventComp>();
+    assert(&previousSet == frontBuffer);
+    assert(previousSet.size() == 1);
+    assert(!cm.exists<TestEventComp>());
+
+    cm.add<TestEventComp>(id2);
+    assert(cm.contains<TestEventComp>(id2));
+    assert(!cm.contains<TestEventComp>(id1));
+
+    cm.clear<ECS::Tags::Event>();
+
+    auto [recycledSet] = cm.getAll<TestEventComp>();
+    assert(&recycledSet == frontBuffer);
+    assert(recycledSet.size() == 0);
+    assert(cm.getPreviousEvents<TestEventComp>().size() == 1);
+}
+
+inline void test_event_buffers_keep_capacity(CM &cm)
+{
+    PRINT("TESTING EVENT BUFFERS KEEP CAPACITY ACROSS PRUNE AND CLEAR")
+
+    auto eventCapacity = [&]() {
+        size_t capacity = 0;
+        for (const auto &stats : cm.memoryStats(false).components)
+            capacity += stats.denseCapacity;
+
+        return capacity;
+    };
+
+    for (EntityId id = 1; id <= 64; ++id)
+        cm.add<TestEventComp>(id);
+    cm.clear<ECS::Tags::Event>();
+    for (EntityId id = 1; id <= 64; ++id)
+        cm.add<TestEventComp>(id);
+
+    auto [frontSet] = cm.getAll<TestEventComp>();
+    auto *frontBuffer = &frontSet;
+    auto *backBuffer = &cm.getPreviousEvents<TestEventComp>();
+    auto capacity = eventCapacity();
+    assert(capacity >= 128);
+
+    cm.clear<TestEventComp>();
+    cm.prune<TestEventComp>();
+
+    assert(!cm.exists<TestEventComp>());
+    assert(eventCapacity() == capacity);
+    assert(&cm.getPreviousEvents<TestEventComp>() == backBuffer);
+    assert(cm.getPreviousEvents<TestEventComp>().size() == 64);
+
+    cm.add<TestEventComp>(1);
+
+    auto [refilledSet] = cm.getAll<TestEventComp>();
+    assert(&refilledSet == frontBuffer);
+    assert(eventCapacity() == capacity);
+}
+
+inline void test_custom_tag_batch_operations(CM &)
+{
+    PRINT("TESTING CUSTOM TAG BATCH OPERATIONS")
+
+    ECS::Manager<EntityId, TestBurningTag> cm{};
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    cm.add<TestBurningStackedComp>(id1);
+    cm.add<TestBurningStackedComp>(id1);
+    cm.add<TestBurningNonStackedComp>(id2);
+    cm.add<TestNonStackedComp>(id2);
+
+    int count{};
+    cm.each<TestBurningTag>([&](EId eId, TestBurningTag &burning) {
+        burning.ticksLeft -= eId;
+        count++;
+    });
+
+    assert(count == 3);
+
+    cm.removeIf<TestBurningTag>([&](const TestBurningTag &burning) { return burning.ticksLeft <= 1; });
+    cm.prune<TestBurningTag>();
+
+    assert(cm.exists<TestBurningStackedComp>());
+    assert(!cm.exists<TestBurningNonStackedComp>());
+    assert(cm.exists<TestNonStackedComp>());
+
+    cm.add<TestBurningNonStackedComp>(id2);
+    cm.clear<TestBurningTag>();
+
+    assert(!cm.exists<TestBurningStackedComp>());
+    assert(!cm.exists<TestBurningNonStackedComp>());
+    assert(cm.exists<TestNonStackedComp>());
+
+    count = 0;
+    cm.each<TestBurningTag>([&](EId eId, TestBurningTag &burning) { count++; });
+
+    assert(count == 0);
+}
+
 inline void test_clear_all_by_entity(CM &cm)
 {
     PRINT("TESTING CLEAR ALL COMPONENTS BY ENTITY ID")
@@ -436,6 +699,747 @@ inline void test_clear_all_by_entity(CM &cm)
     assert(!cm.contains<TestStackedComp>(id2));
 }
 
+inline void test_observe_component_changes(CM &cm)
+{
+    PRINT("TESTING OBSERVE COMPONENT CHANGES")
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    EntityId id3 = 3;
+
+    std::vector<EntityId> added;
+    std::vector<EntityId> removed;
+    std::vector<EntityId> overwritten;
+    int flushCount{};
+
+    cm.add<TestNonStackedComp>(id1);
+    cm.onAdd<TestNonStackedComp>([&](const std::vector<EntityId> &ids) {
+        added = ids;
+        flushCount++;
+    });
+    cm.onRemove<TestNonStackedComp>([&](const std::vector<EntityId> &ids) { removed = ids; });
+    cm.onOverwrite<TestNonStackedComp>([&](const std::vector<EntityId> &ids) { overwritten = ids; });
+
+    cm.add<TestNonStackedComp>(id2);
+    cm.add<TestNonStackedComp>(id3);
+    cm.overwrite<TestNonStackedComp>(id1, 10);
+    cm.remove<TestNonStackedComp>(id2);
+
+    assert(added.empty());
+
+    cm.flushObservers();
+
+    assert(flushCount == 1);
+    assert((added == std::vector<EntityId>{id2, id3}));
+    assert((removed == std::vector<EntityId>{id2}));
+    assert((overwritten == std::vector<EntityId>{id1}));
+
+    cm.flushObservers();
+    assert(flushCount == 1);
+
+    cm.clear<TestNonStackedComp>();
+    cm.flushObservers();
+
+    assert(removed.size() == 2);
+
+    // Dummy wrappers inserted by a lookup miss never held the component, so erasing them is not a removal
+    EntityId missingId = 4;
+    removed.clear();
+    cm.add<TestNonStackedComp>(id1);
+    auto [missingComps] = cm.get<TestNonStackedComp>(missingId);
+    assert(!missingComps);
+    cm.prune<TestNonStackedComp>();
+    cm.remove<TestNonStackedComp>(missingId);
+    cm.flushObservers();
+
+    assert(removed.empty());
+
+    auto [missingAgain] = cm.get<TestNonStackedComp>(missingId);
+    assert(!missingAgain);
+    cm.clear<TestNonStackedComp>();
+    cm.flushObservers();
+
+    assert((removed == std::vector<EntityId>{id1}));
+
+    // Only the current event buffer is observed
+    std::vector<EntityId> removedEvents;
+    cm.onRemove<TestEventComp>([&](const std::vector<EntityId> &ids) { removedEvents = ids; });
+    cm.add<TestEventComp>(id1);
+    cm.add<TestEventComp>(id2);
+    cm.clear<ECS::Tags::Event>();
+    cm.remove(id1);
+    cm.clear<ECS::Tags::Event>();
+    cm.flushObservers();
+
+    assert(removedEvents.empty());
+}
+
+inline void test_changed_components_since_tick(CM &cm)
+{
+    PRINT("TESTING CHANGED COMPONENTS SINCE TICK")
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    EntityId id3 = 3;
+    EntityId id4 = 4;
+    createEntityWithComponents<TestVelocityComponent, TestPositionComponent>(cm, 3);
+
+    auto sinceTick = cm.getTick();
+    cm.tick();
+
+    auto [posComps] = cm.get<TestPositionComponent>(id2);
+    posComps.mutate([&](TestPositionComponent &pos) { pos.x = 5.0f; });
+    cm.overwrite<TestPositionComponent>(id3);
+    cm.add<TestPositionComponent>(id4);
+
+    std::vector<EntityId> changedIds;
+    auto [posSet] = cm.getAll<TestPositionComponent>();
+    posSet.eachChanged(sinceTick, [&](EId eId, auto &_) { changedIds.push_back(eId); });
+
+    assert((changedIds == std::vector<EntityId>{id2, id3, id4}));
+
+    auto group = cm.getGroup<ECS::Changed<TestPositionComponent>, TestVelocityComponent>(sinceTick);
+
+    assert(group.size() == 2);
+    group.each([&](EId eId, auto &posComps, auto &velComps) { assert(eId == id2 || eId == id3); });
+
+    auto unchangedGroup = cm.getGroup<ECS::Changed<TestPositionComponent>>(cm.getTick());
+    assert(unchangedGroup.size() == 0);
+
+    auto allGroup = cm.getGroup<TestPositionComponent>(cm.getTick());
+    assert(allGroup.size() == 4);
+
+    // Mutating through a derived wrapper stamps the stored wrapper of its entity, even after the set moved it
+    auto [velComps] = cm.get<TestVelocityComponent>(id1);
+    auto derivedComps = velComps.filter([](const TestVelocityComponent &) { return true; });
+    auto [velSet] = cm.getAll<TestVelocityComponent>();
+    velSet.sortBy([](EId eId, auto &_) { return -static_cast<int>(eId); });
+
+    sinceTick = cm.getTick();
+    cm.tick();
+    derivedComps.mutate([](TestVelocityComponent &vel) { vel.x = 2.0f; });
+
+    auto derivedGroup = cm.getGroup<ECS::Changed<TestVelocityComponent>>(sinceTick);
+    assert(derivedGroup.size() == 1);
+    derivedGroup.each([&](EId eId, auto &_) { assert(eId == id1); });
+}
+
+inline void test_spatial_index_queries(CM &cm)
+{
+    PRINT("TESTING SPATIAL INDEX QUERIES")
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    EntityId id3 = 3;
+    cm.add<TestGridPositionComp>(id1, 1.0f, 1.0f);
+    cm.add<TestGridPositionComp>(id2, 4.0f, 0.0f);
+    cm.add<TestGridPositionComp>(id3, -30.0f, 12.0f);
+
+    auto &grid = cm.spatialIndex(&TestGridPositionComp::x, &TestGridPositionComp::y, 8.0f);
+    assert(&grid == &cm.spatialIndex(&TestGridPositionComp::x, &TestGridPositionComp::y, 16.0f));
+
+    auto sorted = [](std::vector<EntityId> ids) {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    assert((sorted(grid.queryRadius(0.0f, 0.0f, 4.0f)) == std::vector<EntityId>{id1, id2}));
+    assert((grid.queryRadius(0.0f, 0.0f, 2.0f) == std::vector<EntityId>{id1}));
+    assert((grid.queryAABB(-40.0f, 10.0f, -20.0f, 20.0f) == std::vector<EntityId>{id3}));
+
+    auto [posComps] = cm.get<TestGridPositionComp>(id3);
+    posComps.mutate([](TestGridPositionComp &pos) {
+        pos.x = 2.0f;
+        pos.y = -1.0f;
+    });
+    cm.overwrite<TestGridPositionComp>(id2, 100.0f, 100.0f);
+
+    assert((sorted(grid.queryRadius(0.0f, 0.0f, 4.0f)) == std::vector<EntityId>{id1, id3}));
+    assert(grid.queryAABB(-40.0f, 10.0f, -20.0f, 20.0f).empty());
+    assert((grid.queryAABB(99.0f, 99.0f, 101.0f, 101.0f) == std::vector<EntityId>{id2}));
+
+    cm.remove<TestGridPositionComp>(id1);
+    assert((grid.queryRadius(0.0f, 0.0f, 4.0f) == std::vector<EntityId>{id3}));
+
+    cm.clear<TestGridPositionComp>();
+    assert(grid.queryAABB(-1000.0f, -1000.0f, 1000.0f, 1000.0f).empty());
+
+    cm.add<TestGridPositionComp>(id1, 0.5f, 0.5f);
+    assert((grid.queryRadius(0.0f, 0.0f, 1.0f) == std::vector<EntityId>{id1}));
+
+    // Mutations made after a query within the same tick are seen by the next query, and querying does not
+    // advance the tick
+    cm.add<TestGridPositionComp>(id2, 20.0f, 20.0f);
+    cm.tick();
+    cm.tick();
+    cm.tick();
+    auto tick = cm.getTick();
+    assert((grid.queryRadius(0.0f, 0.0f, 1.0f) == std::vector<EntityId>{id1}));
+
+    auto [movedComps] = cm.get<TestGridPositionComp>(id1);
+    movedComps.mutate([](TestGridPositionComp &pos) { pos.x = 50.0f; });
+
+    assert(grid.queryRadius(0.0f, 0.0f, 1.0f).empty());
+    assert((grid.queryRadius(50.0f, 0.5f, 1.0f) == std::vector<EntityId>{id1}));
+    assert(cm.getTick() == tick);
+
+    // Only the entities changed since the previous query are re-indexed
+    movedComps.mutate([](TestGridPositionComp &pos) { pos.y = 10.0f; });
+    assert(grid.getChangedLog().size() == 1);
+    assert((grid.queryRadius(50.0f, 10.0f, 1.0f) == std::vector<EntityId>{id1}));
+    assert(grid.getChangedLog().empty());
+
+    // Areas far larger than the occupied cells, and coordinates beyond the range of the cells
+    cm.add<TestGridPositionComp>(id3, 1e12f, -1e12f);
+    assert(grid.queryRadius(0.0f, 0.0f, 1e30f).size() == 3);
+    assert((grid.queryAABB(1e12f, -1e12f, 1e12f, -1e12f) == std::vector<EntityId>{id3}));
+    assert(grid.queryAABB(-1e30f, -1e30f, -1e29f, -1e29f).empty());
+
+    // The queried box of unsigned coordinates does not wrap around zero
+    cm.add<TestCellComp>(id1, 1u, 1u);
+    auto &cells = cm.spatialIndex(&TestCellComp::col, &TestCellComp::row, 4u);
+    assert((cells.queryRadius(2u, 2u, 5u) == std::vector<EntityId>{id1}));
+}
+
+inline void test_field_index_find_by_value(CM &cm)
+{
+    PRINT("TESTING FIELD INDEX FIND BY VALUE")
+
+    EntityId id1 = 1;
+    EntityId id2 = 2;
+    EntityId id3 = 3;
+    cm.add<TestNonStackedComp>(id1, 3);
+    cm.add<TestNonStackedComp>(id2, 3);
+    cm.add<TestNonStackedComp>(id3, 5);
+
+    auto &valIndex = cm.index<TestNonStackedComp>(&TestNonStackedComp::val);
+    assert(&valIndex == &cm.index<TestNonStackedComp>(&TestNonStackedComp::val));
+
+    auto sorted = [](std::vector<EntityId> ids) {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    assert((sorted(valIndex.find(3)) == std::vector<EntityId>{id1, id2}));
+    assert(valIndex.count(5) == 1);
+    assert(valIndex.find(7).empty());
+
+    auto [nonStackedComps] = cm.get<TestNonStackedComp>(id2);
+    nonStackedComps.mutate([](TestNonStackedComp &comp) { comp.val = 5; });
+    cm.overwrite<TestNonStackedComp>(id1, 7);
+
+    assert(valIndex.find(3).empty());
+    assert((sorted(valIndex.find(5)) == std::vector<EntityId>{id2, id3}));
+    assert((valIndex.find(7) == std::vector<EntityId>{id1}));
+
+    cm.remove<TestNonStackedComp>(id3);
+    assert((valIndex.find(5) == std::vector<EntityId>{id2}));
+
+    cm.add<TestStackedComp>(id1, 1);
+    cm.add<TestStackedComp>(id1, 2);
+    cm.add<TestStackedComp>(id2, 2);
+
+    auto &stackedIndex = cm.index<TestStackedComp>(&TestStackedComp::val);
+    assert((sorted(stackedIndex.find(2)) == std::vector<EntityId>{id1, id2}));
+    assert((stackedIndex.find(1) == std::vector<EntityId>{id1}));
+
+    auto [stackedComps] = cm.get<TestStackedComp>(id1);
+    stackedComps.remove([](const TestStackedComp &comp) { return comp.val == 1; });
+
+    assert(stackedIndex.find(1).empty());
+    assert((sorted(stackedIndex.find(2)) == std::vector<EntityId>{id1, id2}));
+
+    // Mutations through derived wrappers are logged for the entity they were derived from
+    stackedComps.first().mutate([](TestStackedComp &comp) { comp.val = 4; });
+    assert((stackedIndex.find(2) == std::vector<EntityId>{id2}));
+    assert((stackedIndex.find(4) == std::vector<EntityId>{id1}));
+}
+
+inline void test_sort_component_sets(CM &cm)
+{
+    PRINT("TESTING SORT COMPONENT SETS")
+
+    std::vector<int> values{5, 3, 4, 1, 2};
+    for (EntityId id = 1; id <= values.size(); ++id)
+        cm.add<TestNonStackedComp>(id, values[id - 1]);
+
+    auto [valSet] = cm.getAll<TestNonStackedComp>();
+    auto byVal = [](EId eId, auto &comps) { return comps.peek(&TestNonStackedComp::val); };
+    valSet.sortBy(byVal);
+
+    assert(std::ranges::equal(valSet.getIds(), std::vector<EntityId>{4, 5, 2, 3, 1}));
+    valSet.each([&](EId eId, auto &comps) {
+        assert(comps.peek(&TestNonStackedComp::val) == values[eId - 1]);
+    });
+
+    auto [comps] = cm.get<TestNonStackedComp>(1);
+    comps.mutate([](TestNonStackedComp &comp) { comp.val = 0; });
+
+    // The miss inserts an empty wrapper, which must not reach the key function
+    auto [missingComps] = cm.get<TestNonStackedComp>(6);
+    assert(!missingComps);
+    valSet.sortBy([](EId eId, auto &comps) {
+        assert(comps);
+        return comps.peek(&TestNonStackedComp::val);
+    });
+
+    // Without auto-pruning, the empty wrapper would still be listed
+    cm.prune<TestNonStackedComp>();
+    assert(std::ranges::equal(valSet.getIds(), std::vector<EntityId>{1, 4, 5, 2, 3}));
+
+    cm.add<TestStackedComp>(3);
+    cm.add<TestStackedComp>(5);
+    cm.add<TestStackedComp>(1);
+    cm.add<TestStackedComp>(7);
+
+    auto [stackedSet] = cm.getAll<TestStackedComp>();
+    auto [missingStacked] = cm.get<TestStackedComp>(4);
+    assert(!missingStacked);
+    stackedSet.sortAs(valSet);
+
+    cm.prune<TestStackedComp>();
+    assert(std::ranges::equal(stackedSet.getIds(), std::vector<EntityId>{1, 5, 3, 7}));
+
+    auto group = cm.getGroup<TestStackedComp, TestNonStackedComp>();
+    assert((group.getIds() == std::vector<EntityId>{1, 5, 3}));
+}
+
+inline void test_memory_stats(CM &cm)
+{
+    PRINT("TESTING MEMORY STATS")
+
+    createEntityWithComponents<TestNonStackedComp>(cm, 3);
+    cm.add<TestStackedComp>(1, 1);
+    cm.add<TestStackedComp>(1, 2);
+    auto [missingComps] = cm.get<TestStackedComp>(2);
+
+    auto stats = cm.memoryStats();
+    assert(stats.components.size() == 2);
+
+    auto findStats = [&]<typename T>() {
+        for (const auto &componentStats : stats.components)
+            if (componentStats.typeName == ECS::internal::Utilities::getTypeName<T>())
+                return componentStats;
+
+        assert(false);
+        return ECS::internal::ComponentMemoryStats{};
+    };
+
+    auto nonStackedStats = findStats.operator()<TestNonStackedComp>();
+    assert(nonStackedStats.liveCount == 3);
+    assert(nonStackedStats.componentCount == 3);
+    assert(nonStackedStats.emptyWrappers == 0);
+    assert(nonStackedStats.heapBytes == 0);
+    assert(nonStackedStats.denseCapacity >= 3);
+    assert(nonStackedStats.sparseSlots > 3);
+
+    auto stackedStats = findStats.operator()<TestStackedComp>();
+    assert(stackedStats.liveCount == 2);
+    assert(stackedStats.componentCount == 2);
+    assert(stackedStats.emptyWrappers == 1);
+    assert(stackedStats.heapBytes >= 2 * sizeof(TestStackedComp));
+
+    assert(stats.totalBytes() == nonStackedStats.totalBytes() + stackedStats.totalBytes());
+
+    auto stackedName = ECS::internal::Utilities::getTypeName<TestStackedComp>();
+    for (const auto &setStats : cm.memoryStats(false).components)
+    {
+        assert(setStats.liveCount > 0);
+        assert(setStats.componentCount == 0 && setStats.heapBytes == 0);
+        assert(setStats.emptyWrappers == (setStats.typeName == stackedName));
+    }
+
+    auto countEmptyWrappers = [&]() {
+        for (const auto &setStats : cm.memoryStats(false).components)
+            if (setStats.typeName == stackedName)
+                return setStats.emptyWrappers;
+
+        return size_t{};
+    };
+
+    auto [stackedComps] = cm.get<TestStackedComp>(1);
+    stackedComps.remove([](const TestStackedComp &) { return true; });
+    assert(countEmptyWrappers() == 2);
+
+    cm.add<TestStackedComp>(2, 3);
+    assert(countEmptyWrappers() == 1);
+
+    cm.remove<TestStackedComp>(1);
+    assert(countEmptyWrappers() == 0);
+
+    // Sampling into kept stats reuses their capacity
+    ECS::MemoryStats sampledStats;
+    cm.memoryStats(sampledStats, false);
+    EXPECT_NO_ALLOC(cm.memoryStats(sampledStats, false));
+    assert(sampledStats.components.size() == 2);
+}
+
+inline void test_iteration_does_not_allocate(CM &cm)
+{
+    PRINT("TESTING ITERATION DOES NOT ALLOCATE")
+
+    createEntityWithComponents<TestVelocityComponent, TestPositionComponent>(cm, 100);
+    cm.add<TestUniqueComp>(1);
+    float sum{};
+
+    EXPECT_NO_ALLOC(for (EntityId eId = 1; eId <= 100; ++eId) {
+        auto [velComps, posComps] = cm.get<TestVelocityComponent, TestPositionComponent>(eId);
+        velComps.inspect([&](const TestVelocityComponent &vel) { sum += vel.x; });
+        posComps.mutate([&](TestPositionComponent &pos) { pos.x += 1.0f; });
+        sum += velComps.peek(&TestVelocityComponent::y);
+    })
+
+    EXPECT_NO_ALLOC(for (EntityId eId = 1; eId <= 200; ++eId) {
+        auto [velComps] = cm.tryGet<TestVelocityComponent>(eId);
+        velComps.inspect([&](const TestVelocityComponent &vel) { sum += vel.x; });
+    })
+
+    EXPECT_NO_ALLOC({
+        auto [posComps] = cm.getAll<TestPositionComponent>();
+        posComps.each([&](EntityId eId, auto &comps) {
+            comps.inspect([&](const TestPositionComponent &pos) { sum += pos.x; });
+        });
+    })
+
+    EXPECT_NO_ALLOC({
+        auto [playerId, playerComps] = cm.getUnique<TestUniqueComp>();
+        playerComps.inspect([&](const TestUniqueComp &_) { sum += playerId; });
+    })
+
+    assert(sum == 401);
+}
+
+inline void test_iteration_covers_every_arrangement(CM &cm)
+{
+    PRINT("TESTING ITERATION COVERS EVERY ARRANGEMENT")
+
+    cm.registerTransformation<TestStackedComp>([](EntityId eId, TestStackedComp comp) {
+        comp.val *= 10;
+        return comp;
+    });
+    for (int i = 1; i <= 4; ++i)
+        cm.add<TestStackedComp>(1, i);
+    cm.add<TestNonStackedComp>(1, 7);
+
+    auto [stackedComps, nonStackedComps] = cm.get<TestStackedComp, TestNonStackedComp>(1);
+    auto sumOf = [](auto &&comps, auto... behavior) {
+        int sum{};
+        comps.inspect([&](const auto &comp) { sum += comp.val; }, behavior...);
+        return sum;
+    };
+
+    assert(sumOf(stackedComps) == 10);
+    assert(sumOf(stackedComps, ECS::internal::Transformation::TRANSFORM) == 100);
+    assert(sumOf(nonStackedComps) == 7);
+
+    auto evenComps = stackedComps.filter([](const TestStackedComp &comp) { return comp.val % 2 == 0; });
+    assert(sumOf(evenComps) == 6);
+    assert(sumOf(evenComps.last()) == 4);
+
+    evenComps.mutate([](TestStackedComp &comp) { comp.val += 1; });
+    assert(sumOf(stackedComps) == 12);
+}
+
+inline void test_top_k_and_selection(CM &cm)
+{
+    PRINT("TESTING TOP K AND SELECTION")
+
+    for (int val : {5, 9, 1, 7, 3, 9, 2})
+        cm.add<TestStackedComp>(1, val);
+
+    auto [stackedComps] = cm.get<TestStackedComp>(1);
+    auto collect = [](auto &&comps) {
+        std::vector<int> vals;
+        comps.inspect([&](const TestStackedComp &comp) { vals.push_back(comp.val); });
+        return vals;
+    };
+    auto byValDesc = [](const TestStackedComp &a, const TestStackedComp &b) { return a.val > b.val; };
+
+    assert(collect(stackedComps.top(3, byValDesc)) == (std::vector<int>{9, 9, 7}));
+    assert(collect(stackedComps.top(10, byValDesc)) == (std::vector<int>{9, 9, 7, 5, 3, 2, 1}));
+    assert(collect(stackedComps.top(0, byValDesc)).empty());
+    assert(collect(stackedComps.minBy(&TestStackedComp::val)) == std::vector<int>{1});
+    assert(collect(stackedComps.maxBy([](const TestStackedComp &comp) { return comp.val; })) ==
+           std::vector<int>{9});
+    assert(collect(stackedComps.nthBy(2, &TestStackedComp::val)) == std::vector<int>{3});
+    assert(collect(stackedComps.nthBy(7, &TestStackedComp::val)).empty());
+    assert(collect(stackedComps.sort(byValDesc)) == (std::vector<int>{9, 9, 7, 5, 3, 2, 1}));
+
+    // Derived wrappers still point at the originals
+    stackedComps.maxBy(&TestStackedComp::val).mutate([](TestStackedComp &comp) { comp.val = 0; });
+    assert(collect(stackedComps.maxBy(&TestStackedComp::val)) == std::vector<int>{9});
+    assert(collect(stackedComps.minBy(&TestStackedComp::val)) == std::vector<int>{0});
+
+    stackedComps.sort(byValDesc).first().mutate([](TestStackedComp &comp) { comp.val = 4; });
+    assert(collect(stackedComps.sort(byValDesc).first()) == std::vector<int>{7});
+
+    for (EntityId eId = 1; eId <= 6; ++eId)
+        cm.add<TestNonStackedComp>(eId, static_cast<int>(eId * 7 % 6));
+
+    for (int val : {4, 8, 6})
+        cm.add<TestBuffComp>(1, val);
+
+    auto [buffComps] = cm.get<TestBuffComp>(1);
+    auto buffVals = [](auto &&comps) {
+        std::vector<int> vals;
+        comps.inspect([&](const TestBuffComp &comp) { vals.push_back(comp.val); });
+        return vals;
+    };
+    assert(buffVals(buffComps.nthBy(1, &TestBuffComp::val)) == std::vector<int>{6});
+    assert(buffVals(buffComps.nthBy(2, &TestBuffComp::val, ECS::internal::Transformation::TRANSFORM)) ==
+           std::vector<int>{8});
+
+    auto group = cm.getGroup<TestNonStackedComp>();
+    auto byVal = [](EntityId eId, auto &comps) { return comps.peek(&TestNonStackedComp::val); };
+    assert(group.topBy(2, byVal) == (std::vector<EntityId>{6, 1}));
+    assert(group.topBy(2, byVal, std::greater<>{}) == (std::vector<EntityId>{5, 4}));
+    assert(group.topBy(0, byVal).empty());
+}
+
+inline void test_field_reductions(CM &cm)
+{
+    PRINT("TESTING FIELD REDUCTIONS")
+
+    for (int val : {5, -2, 9, 4})
+        cm.add<TestStackedComp>(1, val);
+
+    auto [stackedComps] = cm.get<TestStackedComp>(1);
+    assert(stackedComps.sum(&TestStackedComp::val) == 16);
+    assert(stackedComps.min(&TestStackedComp::val) == -2);
+    assert(stackedComps.max(&TestStackedComp::val) == 9);
+    assert(stackedComps.mean(&TestStackedComp::val) == 4.0);
+
+    auto [missingComps] = cm.get<TestStackedComp>(2);
+    assert(missingComps.sum(&TestStackedComp::val) == 0);
+    assert(!missingComps.min(&TestStackedComp::val) && !missingComps.mean(&TestStackedComp::val));
+
+    // Enough values to fill several blocks and carry their sums up the tree
+    for (EntityId eId = 1; eId <= 1000; ++eId)
+    {
+        cm.add<TestPositionComponent>(eId, static_cast<float>(eId), 1.0f);
+        if (eId % 2)
+            cm.add<TestVelocityComponent>(eId, 2.0f, 0.0f);
+    }
+
+    auto [posSet] = cm.getAll<TestPositionComponent>();
+    auto posSummary = posSet.summarize(&TestPositionComponent::x);
+    assert(posSummary.count == 1000 && posSummary.sum == 500500.0f);
+    assert(posSummary.min == 1.0f && posSummary.max == 1000.0f && posSummary.mean() == 500.5);
+
+    auto group = cm.getGroup<TestVelocityComponent, TestPositionComponent>();
+    auto groupSummary = group.summarize(&TestPositionComponent::x);
+    assert(groupSummary.count == 500 && groupSummary.sum == 250000.0f && groupSummary.max == 999.0f);
+    assert(group.summarize(&TestVelocityComponent::x).sum == 1000.0f);
+}
+
+inline void test_lazy_view_of_components(CM &cm)
+{
+    PRINT("TESTING LAZY VIEW OF COMPONENTS")
+
+    cm.registerTransformation<TestStackedComp>([](EntityId eId, TestStackedComp comp) {
+        comp.val *= 10;
+        return comp;
+    });
+    for (int i = 0; i < 10; ++i)
+        cm.add<TestStackedComp>(1, i);
+    cm.add<TestNonStackedComp>(1, 7);
+
+    auto [stackedComps, nonStackedComps] = cm.get<TestStackedComp, TestNonStackedComp>(1);
+    auto isOdd = [](const TestStackedComp &comp) { return comp.val % 2 == 1; };
+
+    auto oddView = stackedComps.view() | std::views::filter(isOdd) | std::views::take(3);
+    static_assert(std::ranges::view<decltype(oddView)>);
+    static_assert(std::is_same_v<std::ranges::range_reference_t<decltype(oddView)>, const TestStackedComp &>);
+
+    int sum{};
+    EXPECT_NO_ALLOC(for (const auto &comp : oddView) sum += comp.val;)
+    assert(sum == 1 + 3 + 5);
+
+    // Transformed values only when asked for, since the component is not Transform-tagged
+    auto transformedView = stackedComps.view(ECS::internal::Transformation::TRANSFORM) | std::views::drop(9);
+    assert(std::ranges::distance(transformedView) == 1 && (*transformedView.begin()).val == 90);
+    assert(std::ranges::distance(stackedComps.view()) == 10);
+
+    for (const auto &comp : nonStackedComps.view())
+        assert(comp.val == 7);
+
+    auto [missingComps] = cm.get<TestStackedComp>(2);
+    assert(std::ranges::empty(missingComps.view()));
+}
+
+#ifdef ecs_enable_memory_resource
+inline void test_sets_allocate_from_memory_resource(CM &cm)
+{
+    PRINT("TESTING SETS ALLOCATE FROM MEMORY RESOURCE")
+
+    struct CountingResource : std::pmr::memory_resource
+    {
+        size_t allocatedBytes{};
+        size_t outstandingBytes{};
+
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            allocatedBytes += bytes;
+            outstandingBytes += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *ptr, size_t bytes, size_t alignment) override
+        {
+            outstandingBytes -= bytes;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    CountingResource resource;
+    {
+        CM resourceCm(&resource);
+        assert(resourceCm.getMemoryResource() == &resource);
+
+        resourceCm.add<TestStackedComp>(1, 1);
+        resourceCm.add<TestNonStackedComp>(2, 2);
+        auto setBytes = resource.allocatedBytes;
+        assert(setBytes > 0);
+
+        // Stacking grows the vector inside the wrapper, which allocates from the resource of its set
+        for (int i = 0; i < 10; ++i)
+            resourceCm.add<TestStackedComp>(1, i);
+        assert(resource.allocatedBytes > setBytes);
+
+        auto [stackedComps] = resourceCm.get<TestStackedComp>(1);
+        assert(stackedComps.size() == 11);
+    }
+    assert(resource.outstandingBytes == 0);
+}
+
+inline void test_derived_wrappers_allocate_from_scratch(CM &cm)
+{
+    PRINT("TESTING DERIVED WRAPPERS ALLOCATE FROM SCRATCH")
+
+    assert(!cm.getScratchResource());
+    cm.reserveScratch();
+    for (int i = 0; i < 10; ++i)
+        cm.add<TestStackedComp>(1, i);
+
+    auto [stackedComps] = cm.get<TestStackedComp>(1);
+    auto isEven = [](const TestStackedComp &comp) { return comp.val % 2 == 0; };
+    auto byValDesc = [](const TestStackedComp &a, const TestStackedComp &b) { return a.val > b.val; };
+    int sum{};
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        EXPECT_NO_ALLOC({
+            auto sorted = stackedComps.filter(isEven).sort(byValDesc);
+            sorted.first().inspect([&](const TestStackedComp &comp) { sum += comp.val; });
+            sorted.last().inspect([&](const TestStackedComp &comp) { sum += comp.val; });
+            stackedComps.find([](const TestStackedComp &comp) { return comp.val == 5; })
+                .inspect([&](const TestStackedComp &comp) { sum += comp.val; });
+        })
+
+        cm.resetScratch();
+    }
+
+    assert(sum == 3 * (8 + 0 + 5));
+}
+#endif
+
+#ifdef ecs_enable_counters
+inline void test_hot_path_counters(CM &cm)
+{
+    PRINT("TESTING HOT PATH COUNTERS")
+
+    auto discarded = cm.snapshotCounters();
+
+    cm.add<TestEffectComp>(1, 1);
+    auto [missingComps] = cm.get<TestEffectComp>(2);
+    auto [comps] = cm.get<TestEffectComp>(1);
+    comps.remove([](const TestEffectComp &comp) { return true; });
+    cm.prune<TestEffectComp>();
+
+    auto counters = cm.snapshotCounters();
+    assert(counters.dummyInserts == 1);
+    assert(counters.prunePasses == 1);
+    assert(counters.prunedElements == 2);
+    assert(counters.setLookups > 0);
+
+    auto emptyCounters = cm.snapshotCounters();
+    assert(emptyCounters.setLookups == 0 && emptyCounters.prunePasses == 0);
+
+    std::thread([] {
+        CM otherCm;
+        auto [otherMissingComps] = otherCm.get<TestEffectComp>(1);
+    }).join();
+
+    assert(cm.snapshotCounters().dummyInserts == 0);
+}
+#endif
+
+#ifdef ecs_enable_tracing
+inline void test_trace_events_written_as_json(CM &cm)
+{
+    PRINT("TESTING TRACE EVENTS WRITTEN AS JSON")
+
+    auto &tracer = ECS::Tracer::instance();
+    tracer.clear();
+
+    createEntityWithComponents<TestVelocityComponent, TestPositionComponent>(cm, 3);
+    {
+        ECS::TraceScope systemScope{"movementSystem"};
+        auto group = cm.getGroup<TestVelocityComponent, TestPositionComponent>();
+        group.each([](EId eId, auto &velComps, auto &posComps) {});
+    }
+
+    std::stringstream json;
+    tracer.writeJson(json);
+    auto trace = json.str();
+
+    assert(trace.starts_with("{\"traceEvents\":["));
+    assert(trace.find("\"name\":\"movementSystem\",\"cat\":\"system\"") != std::string::npos);
+    assert(trace.find("\"name\":\"getGroup\",\"cat\":\"ecs\"") != std::string::npos);
+    assert(trace.find("\"name\":\"Grouping::each\"") != std::string::npos);
+    assert(trace.find("\"name\":\"prune\"") == std::string::npos);
+
+    tracer.clear();
+    std::stringstream emptyJson;
+    tracer.writeJson(emptyJson);
+    assert(emptyJson.str().find("\"name\"") == std::string::npos);
+
+    {
+        ECS::TraceScope quotedScope{"say \"hi\"\\\n"};
+    }
+    std::stringstream escapedJson;
+    tracer.writeJson(escapedJson);
+    assert(escapedJson.str().find("\"name\":\"say \\\"hi\\\"\\\\\\u000a\"") != std::string::npos);
+    tracer.clear();
+
+    // Timestamps keep their nanoseconds however long the trace has been running
+    tracer.getThreadBuffer().record({"lateSystem", "system", 3'600'000'000'001, 1'500});
+    std::stringstream lateJson;
+    tracer.writeJson(lateJson);
+    assert(lateJson.str().find("\"ts\":3600000000.001,\"dur\":1.500") != std::string::npos);
+    tracer.clear();
+
+    // The first scope of a thread acquires its buffer when it opens, rather than within its own duration
+    std::thread([] {
+        std::optional<ECS::TraceScope> firstScope{std::in_place, "firstSystem"};
+        Allocations::Scope allocationScope;
+        firstScope.reset();
+        assert(allocationScope.getAllocations() == 0);
+    }).join();
+    tracer.clear();
+
+    auto traceOnThread = [] { std::thread([] { ECS::TraceScope threadScope{"threadSystem"}; }).join(); };
+    traceOnThread();
+    auto bufferCount = tracer.getBufferCount();
+    traceOnThread();
+    assert(tracer.getBufferCount() == bufferCount);
+}
+#endif
+
 inline void test_prune(CM &cm)
 {
     PRINT("TESTING PRUNE")